@@ -0,0 +1,115 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/fileutil.h"
+#include "util/json.h"
+#include "util/timer.h"
+
+namespace tfr {
+
+struct benchmark_result {
+	std::string name;
+	uint64_t elements{};
+	uint64_t bytes{};
+	uint64_t nanoseconds{};
+
+	double ns_per_element() const {
+		return static_cast<double>(nanoseconds) / static_cast<double>(std::max<uint64_t>(elements, 1));
+	}
+
+	// bytes per nanosecond is the same as gigabytes per second
+	double gb_per_second() const {
+		return static_cast<double>(bytes) / static_cast<double>(std::max<uint64_t>(nanoseconds, 1));
+	}
+};
+
+// A benchmark returns a checksum of its work so that the compiler can not remove it.
+struct benchmark {
+	std::string name;
+	uint64_t elements{};
+	uint64_t bytes{};
+	std::function<uint64_t()> run;
+};
+
+using benchmarks = std::vector<benchmark>;
+
+inline volatile uint64_t benchmark_sink{};
+
+// best of a number of repetitions, the first repetition also warms up caches
+inline benchmark_result run_benchmark(const benchmark& b, int repetitions) {
+	uint64_t best = std::numeric_limits<uint64_t>::max();
+	for (int i = 0; i < repetitions; ++i) {
+		const timer t;
+		benchmark_sink = benchmark_sink ^ b.run();
+		best = std::min(best, static_cast<uint64_t>(t.nanoseconds()));
+	}
+	return {b.name, b.elements, b.bytes, best};
+}
+
+inline json_object to_json(const benchmark_result& r) {
+	return json_object()
+	       .add("name", r.name)
+	       .add("elements", r.elements)
+	       .add("bytes", r.bytes)
+	       .add("nanoseconds", r.nanoseconds)
+	       .add("ns_per_element", r.ns_per_element())
+	       .add("gb_per_second", r.gb_per_second());
+}
+
+inline bool save_baseline(const std::string& path, const std::vector<benchmark_result>& results) {
+	std::string lines;
+	for (const auto& r : results) {
+		lines += to_json(r).to_string() + "\n";
+	}
+	return write(path, lines);
+}
+
+namespace detail {
+// only reads back the flat objects written by save_baseline
+inline std::string find_json_string(const std::string& line, const std::string& key) {
+	const auto prefix = "\"" + key + "\":\"";
+	auto pos = line.find(prefix);
+	if (pos == std::string::npos) {
+		return {};
+	}
+	std::string value;
+	for (pos += prefix.size(); pos < line.size() && line[pos] != '"'; ++pos) {
+		if (line[pos] == '\\' && pos + 1 < line.size()) {
+			++pos;
+		}
+		value += line[pos];
+	}
+	return value;
+}
+
+inline std::optional<double> find_json_number(const std::string& line, const std::string& key) {
+	const auto prefix = "\"" + key + "\":";
+	const auto pos = line.find(prefix);
+	if (pos == std::string::npos) {
+		return {};
+	}
+	return std::strtod(line.c_str() + pos + prefix.size(), nullptr);
+}
+}
+
+// benchmark name to ns per element
+inline std::map<std::string, double> load_baseline(const std::string& path) {
+	std::map<std::string, double> baseline;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		const auto name = detail::find_json_string(line, "name");
+		const auto ns = detail::find_json_number(line, "ns_per_element");
+		if (!name.empty() && ns) {
+			baseline[name] = *ns;
+		}
+	}
+	return baseline;
+}
+
+}
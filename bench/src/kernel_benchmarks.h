@@ -0,0 +1,132 @@
+#pragma once
+
+#include "benchmark.h"
+#include "mixers8.h"
+#include "mixers16.h"
+#include "mixers32.h"
+#include "mixers64.h"
+#include "streams.h"
+#include "statistics/avalanche.h"
+#include "statistics/binary_rank.h"
+#include "statistics/coupon.h"
+#include "statistics/distributions.h"
+#include "statistics/linear_complexity.h"
+#include "statistics/permutation.h"
+
+namespace tfr {
+namespace detail {
+template <typename T>
+std::vector<T> create_benchmark_data(uint64_t n) {
+	const auto mix = get_default_mixer<T>();
+	std::vector<T> data;
+	data.reserve(n);
+	for (uint64_t i = 0; i < n; ++i) {
+		data.push_back(mix(static_cast<T>(i)));
+	}
+	return data;
+}
+
+template <typename T>
+std::string benchmark_name(const std::string& kernel) {
+	return kernel + "/" + std::to_string(bit_sizeof<T>());
+}
+
+inline uint64_t checksum(const std::vector<uint64_t>& counts) {
+	uint64_t sum = 0;
+	for (const auto c : counts) {
+		sum = sum * 31 + c;
+	}
+	return sum;
+}
+}
+
+template <typename T>
+benchmarks create_kernel_benchmarks(uint64_t n) {
+	using namespace detail;
+	constexpr auto Bits = bit_sizeof<T>();
+	const auto data = std::make_shared<const std::vector<T>>(create_benchmark_data<T>(n));
+	const auto bytes = n * sizeof(T);
+	benchmarks bs;
+
+	bs.push_back({benchmark_name<T>("bin_data_for_chi2"), n, bytes, [data] {
+		return checksum(bin_data_for_chi2(*data, create_bin_count_pow2<T>()));
+	}});
+
+	bs.push_back({benchmark_name<T>("sliding_bit_window"), n, bytes, [data] {
+		uint64_t sum = 0;
+		sliding_bit_window(*data, 12, [&sum](uint64_t v) { sum += v; });
+		return sum;
+	}});
+
+	// elements are the bits of all matrices
+	constexpr uint64_t matrix_size = 64;
+	const auto rank_data = std::make_shared<std::vector<binary_square_matrix>>();
+	for_each_matrix(*data, matrix_size, [&rank_data](const binary_square_matrix& m) {
+		rank_data->push_back(m);
+	});
+	const auto matrix_bits = rank_data->size() * matrix_size * matrix_size;
+	bs.push_back({benchmark_name<T>("row_reduce_and_rank"), matrix_bits, matrix_bits / 8, [rank_data] {
+		uint64_t sum = 0;
+		for (auto m : *rank_data) {
+			sum += row_reduce_and_rank(m);
+		}
+		return sum;
+	}});
+
+	// elements are the bits of all blocks, using the lowest bit of each value like the test
+	constexpr uint64_t block_size = 1024;
+	const auto bm_data = std::make_shared<std::vector<std::vector<int>>>();
+	for (uint64_t i = 0; i + block_size <= std::min<uint64_t>(n, block_size * 64); i += block_size) {
+		auto& bits = bm_data->emplace_back();
+		for (uint64_t j = 0; j < block_size; ++j) {
+			bits.push_back(is_bit_set((*data)[i + j], 0) ? 1 : 0);
+		}
+	}
+	bs.push_back({benchmark_name<T>("berlekamp_massey"), bm_data->size() * block_size, bm_data->size() * block_size * sizeof(T), [bm_data] {
+		uint64_t sum = 0;
+		for (const auto& bits : *bm_data) {
+			sum += berlekamp_massey(bits);
+		}
+		return sum;
+	}});
+
+	bs.push_back({benchmark_name<T>("collect_coupons"), n, bytes, [data] {
+		return checksum(collect_coupons(5, 20, *data));
+	}});
+
+	// elements are mixer inputs, every input costs bits + 1 mixer calls
+	const auto sac_n = std::max<uint64_t>(n / Bits, 1);
+	bs.push_back({benchmark_name<T>("avalanche_generate_sac"), sac_n, sac_n * sizeof(T), [sac_n] {
+		return checksum(avalanche_generate_sac(sac_n, create_counter_stream<T>(1), get_default_mixer<T>()));
+	}});
+
+	const auto bic_n = std::max<uint64_t>(n / (Bits * Bits), 1);
+	bs.push_back({benchmark_name<T>("avalanche_generate_bic"), bic_n, bic_n * sizeof(T), [bic_n] {
+		return checksum(avalanche_generate_bic(bic_n, create_counter_stream<T>(1), get_default_mixer<T>()));
+	}});
+	return bs;
+}
+
+// elements are cdf evaluations, there is no memory throughput
+inline benchmarks create_distribution_benchmarks(uint64_t n) {
+	benchmarks bs;
+	const auto add = [&bs, n](const std::string& name, const std::function<double(double)>& cdf) {
+		bs.push_back({name, n, 0, [n, cdf] {
+			double sum = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				sum += cdf((static_cast<double>(i) + .5) / static_cast<double>(n));
+			}
+			return static_cast<uint64_t>(sum * 1e6);
+		}});
+	};
+	add("normal_cdf", [](double x) { return normal_cdf(6 * x - 3); });
+	add("chi2_distribution_cdf", [](double x) { return chi2_distribution_cdf(200 * x, 100); });
+	add("chi2_distribution_gamma_cdf/4096", [](double x) { return chi2_distribution_gamma_cdf(8192 * x, 4096); });
+	add("chi2_distribution_cdf/4096", [](double x) { return chi2_distribution_cdf(8192 * x, 4096); });
+	add("kolmogorov_smirnov_cdf", [](double x) { return kolmogorov_smirnov_cdf(.5 * x, 128, 100); });
+	add("anderson_darling_cdf", [](double x) { return anderson_darling_cdf(4 * x, 128); });
+	add("binomial_cdf", [](double x) { return binomial_cdf(64, .5, static_cast<uint32_t>(64 * x)); });
+	return bs;
+}
+
+}
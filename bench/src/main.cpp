@@ -0,0 +1,141 @@
+#include <charconv>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "kernel_benchmarks.h"
+#include "stream_benchmarks.h"
+#include "util/table.h"
+
+namespace tfr {
+
+struct bench_options {
+	int power_of_two = 20;
+	int repetitions = 3;
+	std::string filter;
+	std::string save_path;
+	std::string compare_path;
+	double threshold_percent = 10;
+};
+
+benchmarks create_benchmarks(uint64_t n) {
+	benchmarks bs;
+	const auto add = [&bs](const benchmarks& more) {
+		bs.insert(bs.end(), more.begin(), more.end());
+	};
+	add(create_kernel_benchmarks<uint8_t>(n));
+	add(create_kernel_benchmarks<uint16_t>(n));
+	add(create_kernel_benchmarks<uint32_t>(n));
+	add(create_kernel_benchmarks<uint64_t>(n));
+	add(create_distribution_benchmarks(n >> 6));
+	add(create_stream_benchmarks<uint8_t>(n));
+	add(create_stream_benchmarks<uint16_t>(n));
+	add(create_stream_benchmarks<uint32_t>(n));
+	add(create_stream_benchmarks<uint64_t>(n));
+	return bs;
+}
+
+// returns the number of regressions compared to the baseline
+int run_benchmarks(const bench_options& options) {
+	const auto baseline = options.compare_path.empty() ? std::map<std::string, double>{} : load_baseline(options.compare_path);
+	std::vector<benchmark_result> results;
+	int regressions = 0;
+	table t({"benchmark", "elements", "ns/element", "GB/s", "baseline ns/element", "change"});
+	for (const auto& b : create_benchmarks(1ull << options.power_of_two)) {
+		if (b.name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		const auto& r = results.emplace_back(run_benchmark(b, options.repetitions));
+		t.col(r.name).col(r.elements).col(r.ns_per_element()).col(r.bytes > 0 ? std::to_string(r.gb_per_second()) : "-");
+		const auto it = baseline.find(r.name);
+		if (it != baseline.end() && it->second > 0) {
+			const auto change = 100. * (r.ns_per_element() - it->second) / it->second;
+			const auto regressed = change > options.threshold_percent;
+			regressions += regressed ? 1 : 0;
+			t.col(it->second).col(std::to_string(change) + "%" + (regressed ? " regression" : ""));
+		}
+		else {
+			t.col("-").col("-");
+		}
+		t.row();
+		std::cout << r.name << "\n";
+	}
+	std::cout << "\n" << t.to_string() << "\n";
+
+	if (!options.save_path.empty()) {
+		assertion(save_baseline(options.save_path, results), "could not write the benchmark baseline");
+		std::cout << "Wrote baseline " << options.save_path << "\n";
+	}
+	if (!baseline.empty()) {
+		std::cout << regressions << " regressions over " << options.threshold_percent << "% compared to " << options.compare_path << "\n";
+	}
+	return regressions;
+}
+
+const char* usage = "Usage: tfr-bench [--power n] [--repetitions n] [--filter text] [--save baseline.jsonl] [--compare baseline.jsonl] [--threshold percent]\n";
+
+// an invalid option, printed with the usage
+class option_error : public std::invalid_argument {
+public:
+	using std::invalid_argument::invalid_argument;
+};
+
+// all of the text as a number from min to max, throws option_error otherwise
+template <typename T>
+T parse_option_number(const std::string& option, const std::string& text, T min, T max = std::numeric_limits<T>::max()) {
+	T value{};
+	const auto* end = text.data() + text.size();
+	const auto r = std::from_chars(text.data(), end, value);
+	if (r.ec != std::errc() || r.ptr != end || value < min || value > max) {
+		throw option_error("Invalid value " + text + " for " + option);
+	}
+	return value;
+}
+
+bench_options parse_options(int argc, char** args) {
+	bench_options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string option = args[i];
+		const auto has_value = i + 1 < argc;
+		if (option == "--power" && has_value) {
+			// the distribution benchmarks use n / 64
+			options.power_of_two = parse_option_number(option, args[++i], 6, 40);
+		}
+		else if (option == "--repetitions" && has_value) {
+			options.repetitions = parse_option_number(option, args[++i], 1);
+		}
+		else if (option == "--filter" && has_value) {
+			options.filter = args[++i];
+		}
+		else if (option == "--save" && has_value) {
+			options.save_path = args[++i];
+		}
+		else if (option == "--compare" && has_value) {
+			options.compare_path = args[++i];
+		}
+		else if (option == "--threshold" && has_value) {
+			options.threshold_percent = parse_option_number(option, args[++i], 0.);
+		}
+		else {
+			throw option_error("Unknown option " + option);
+		}
+	}
+	return options;
+}
+
+}
+
+int main(int argc, char** args) {
+	using namespace tfr;
+	try {
+		return run_benchmarks(parse_options(argc, args)) > 0 ? 2 : 0;
+	}
+	catch (const option_error& e) {
+		std::cout << e.what() << "\n" << usage;
+		return 1;
+	}
+	catch (const std::exception& e) {
+		std::cout << "ERROR: " << e.what() << "\n";
+		return 1;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "benchmark.h"
+#include "mixers8.h"
+#include "mixers16.h"
+#include "mixers32.h"
+#include "mixers64.h"
+#include "prngs8.h"
+#include "prngs16.h"
+#include "prngs32.h"
+#include "prngs64.h"
+
+namespace tfr {
+
+// Generation through the same std::function interfaces the tests use, one element is one value.
+template <typename T>
+benchmarks create_stream_benchmarks(uint64_t n) {
+	benchmarks bs;
+	const auto bytes = n * sizeof(T);
+	for (const auto& m : get_mixers<T>()) {
+		bs.push_back({m.name, n, bytes, [m, n] {
+			T sum = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				sum ^= m(static_cast<T>(i));
+			}
+			return static_cast<uint64_t>(sum);
+		}});
+	}
+
+	const seed_data seed{1234, mix64::mx3(1), mix64::mx3(2), mix64::mx3(3)};
+	for (const auto& create_prng : get_prngs<T>()) {
+		auto prng = create_prng(seed);
+		bs.push_back({prng.name, n, bytes, [create_prng, seed, n] {
+			auto s = create_prng(seed);
+			T sum = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				sum ^= s();
+			}
+			return static_cast<uint64_t>(sum);
+		}});
+	}
+	return bs;
+}
+
+}
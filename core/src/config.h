@@ -7,6 +7,33 @@ namespace tfr {
 
 struct config {
 	std::string root_path;
+	bool resume = false;
+	bool breadth_first = false;
+	bool profile = false;
+	bool genetic = false;
+	// -search --genetic: evaluation budget and population size, 0 for the defaults of genetic_config
+	uint64_t genetic_evaluations = 0;
+	std::size_t genetic_population = 0;
+	// -search: race the candidates of a step through increasing powers of two
+	bool racing = false;
+	// parameter space of -exhaust, empty for the default grid
+	std::string grid;
+	// coordinator: address and port to accept workers on (0 runs locally) and the workers to wait for
+	std::string listen_address = "127.0.0.1";
+	uint16_t listen_port = 0;
+	int workers = 1;
+	// worker: coordinator to connect to
+	std::string coordinator_host = "localhost";
+	uint16_t coordinator_port = 0;
+	// shared by the coordinator and its workers, required unless the coordinator listens on loopback
+	std::string token;
+	// -ppm: width and height of the images and whether to write png instead of pgm
+	int image_size = 512;
+	bool png = false;
+	// -diagnostics: consecutive pairs of the lag-1 plot, independent of the image size
+	uint64_t lag_samples = 1ull << 26;
+	// -diagnostics: a mixer of a search family such as xm2x/16,15,16,2471660141, empty for the known mixers
+	std::string mixer;
 
 	std::string data_dir() const {
 		return root_path + "data/";
@@ -16,16 +43,47 @@ struct config {
 		return root_path;
 	}
 
+	std::string cache_dir() const {
+		return result_dir() + "cache/";
+	}
+
 	template <typename T>
 	std::string test_result_file_path() const {
 		return result_dir() + "result_" + std::to_string(bit_sizeof<T>()) + ".md";
 	}
 
+	template <typename T>
+	std::string test_result_json_file_path() const {
+		return result_dir() + "result_" + std::to_string(bit_sizeof<T>()) + ".jsonl";
+	}
+
+	template <typename T>
+	std::string test_timing_json_file_path() const {
+		return result_dir() + "timing_" + std::to_string(bit_sizeof<T>()) + ".jsonl";
+	}
+
+	std::string cost_model_file_path() const {
+		return result_dir() + "cost_model.tsv";
+	}
+
+	std::string checkpoint_file_path(const std::string& name) const {
+		return result_dir() + "checkpoint_" + name + ".tsv";
+	}
+
 	template <typename T>
 	std::string ppm_dir() const {
 		return result_dir() + "ppm" + std::to_string(bit_sizeof<T>()) + "/";
 	}
 
+	template <typename T>
+	std::string diagnostics_dir() const {
+		return result_dir() + "diagnostics" + std::to_string(bit_sizeof<T>()) + "/";
+	}
+
+	std::string image_extension() const {
+		return png ? ".png" : ".pgm";
+	}
+
 	std::string trng_file_path() const {
 		return data_dir() + "trng.bin";
 	}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "util/fileutil.h"
+
+namespace tfr {
+
+// Predicts the run time of a single test job (one test over one source) as t = c * n^e
+// nanoseconds, per test and word size. The exponent absorbs the limit_n_* caps of the
+// slower tests. Coefficients start out as rough defaults, can be calibrated from two
+// measured runs and are refined by every job that is recorded.
+class cost_model {
+public:
+	struct coefficients {
+		double ns_per_element{};
+		double exponent = 1;
+		uint64_t samples{};
+	};
+
+	double predict_nanoseconds(test_type type, int bits, uint64_t n) const {
+		const auto c = get(type, bits);
+		return c.ns_per_element * std::pow(static_cast<double>(n), c.exponent);
+	}
+
+	coefficients get(test_type type, int bits) const {
+		std::lock_guard lg(_mutex);
+		const auto it = _coefficients.find({type, bits});
+		return it != _coefficients.end() ? it->second : get_default(type, bits);
+	}
+
+	void set(test_type type, int bits, const coefficients& c) {
+		assertion(is_valid(c.ns_per_element) && is_valid(c.exponent), "invalid cost model coefficients");
+		std::lock_guard lg(_mutex);
+		_coefficients[{type, bits}] = c;
+	}
+
+	// fits both coefficients from two runs of the same job at different n
+	void calibrate(test_type type, int bits, uint64_t n1, uint64_t ns1, uint64_t n2, uint64_t ns2) {
+		assertion(n1 < n2, "calibration expects n1 < n2");
+		auto c = get_default(type, bits);
+		if (ns1 > 0 && ns2 > ns1) {
+			const double e = std::log(static_cast<double>(ns2) / ns1) / std::log(static_cast<double>(n2) / n1);
+			c.exponent = std::clamp(e, 0.25, 1.5);
+		}
+		if (ns2 > 0) {
+			c.ns_per_element = ns2 / std::pow(static_cast<double>(n2), c.exponent);
+		}
+		c.samples = 1;
+		set(type, bits, c);
+	}
+
+	// refines the constant factor from a measured job, the exponent is kept
+	void record(test_type type, int bits, uint64_t n, uint64_t ns) {
+		if (n == 0) {
+			return;
+		}
+		std::lock_guard lg(_mutex);
+		auto it = _coefficients.find({type, bits});
+		if (it == _coefficients.end()) {
+			it = _coefficients.emplace(std::make_pair(type, bits), get_default(type, bits)).first;
+		}
+		auto& c = it->second;
+		const double observed = ns / std::pow(static_cast<double>(n), c.exponent);
+		// running mean over the first samples then an exponential moving average
+		const double weight = 1. / static_cast<double>(std::min<uint64_t>(c.samples + 1, 64));
+		c.ns_per_element += weight * (observed - c.ns_per_element);
+		++c.samples;
+	}
+
+	bool save(const std::string& path) const {
+		std::ostringstream os;
+		std::lock_guard lg(_mutex);
+		for (const auto& e : _coefficients) {
+			os << static_cast<int>(e.first.first) << "\t" << e.first.second << "\t"
+				<< std::setprecision(17) << e.second.ns_per_element << "\t"
+				<< e.second.exponent << "\t" << e.second.samples << "\n";
+		}
+		return write(path, os.str());
+	}
+
+	bool load(const std::string& path) {
+		std::ifstream file(path);
+		if (!file.good()) {
+			return false;
+		}
+		std::lock_guard lg(_mutex);
+		int type, bits;
+		coefficients c;
+		while (file >> type >> bits >> c.ns_per_element >> c.exponent >> c.samples) {
+			_coefficients[{static_cast<test_type>(type), bits}] = c;
+		}
+		return true;
+	}
+
+	static coefficients get_default(test_type type, int bits) {
+		// rough relative costs until calibrated, exponents follow the limit_n_* caps
+		constexpr double slow = 6. / 7.;
+		constexpr double slower = 5. / 7.;
+		switch (type) {
+		case test_type::sac: return {2. * bits, slow};
+		case test_type::bic: return {.25 * bits * bits, slower};
+		case test_type::binary_rank: return {8, slower};
+		case test_type::linear_complexity: return {64, slower};
+		case test_type::coupon: return {4, slower};
+		case test_type::gap:
+		case test_type::divisibility:
+		case test_type::permutation: return {4, slow};
+		default: return {2, 1};
+		}
+	}
+
+private:
+	mutable std::mutex _mutex;
+	std::map<std::pair<test_type, int>, coefficients> _coefficients;
+};
+
+inline cost_model& get_cost_model() {
+	static cost_model model;
+	return model;
+}
+
+// Longest processing time first schedule of the given job costs over a number of threads,
+// returns the predicted makespan.
+inline double predict_makespan(std::vector<double> costs, unsigned int threads) {
+	std::sort(costs.begin(), costs.end(), std::greater());
+	std::vector<double> loads(std::max(threads, 1u), 0.);
+	for (const auto c : costs) {
+		*std::min_element(loads.begin(), loads.end()) += c;
+	}
+	return *std::max_element(loads.begin(), loads.end());
+}
+
+}
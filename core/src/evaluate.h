@@ -1,10 +1,15 @@
 #pragma once
 
+#include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+#include "cost_model.h"
+#include "result_cache.h"
 #include "test_definitions.h"
+#include "util/hash.h"
 #include "util/jobs.h"
 #include "util/timer.h"
 
@@ -18,6 +23,9 @@ struct test_setup {
 	unsigned int max_threads = default_max_threads();
 	int start_power_of_two = 10;
 	int stop_power_of_two = 25;
+	std::shared_ptr<const result_cache> cache;
+	std::shared_ptr<job_pool> pool;
+	bool profile = false;
 
 	test_setup& set_tests(const std::vector<test_type>& test_types) {
 		tests = test_types;
@@ -31,11 +39,33 @@ struct test_setup {
 		stop_power_of_two = stop_power;
 		return *this;
 	}
+
+	test_setup& set_cache(std::shared_ptr<const result_cache> result_cache) {
+		cache = std::move(result_cache);
+		return *this;
+	}
+
+	// shares the worker threads with other setups instead of starting max_threads new ones
+	test_setup& set_pool(std::shared_ptr<job_pool> job_pool) {
+		pool = std::move(job_pool);
+		return *this;
+	}
+
+	// records hardware counters per job where perf events are available
+	test_setup& set_profile(bool enabled) {
+		profile = enabled;
+		return *this;
+	}
 };
 
 
 namespace internal {
-using test_job_return = std::vector<test_result>;
+struct test_job_result {
+	std::vector<test_result> results;
+	job_timing timing;
+};
+
+using test_job_return = test_job_result;
 using test_job = job<test_job_return>;
 using test_jobs = jobs<test_job_return>;
 
@@ -44,40 +74,120 @@ stream<T> create_stream(const std::optional<mixer<T>>& mix, const stream<T>& sou
 	return mix ? create_stream_from_mixer<T>(source, *mix) : source;
 }
 
+// times a sample of a fresh copy of the stream once per stream name, every job of the stream reuses it
+template <typename T>
+double generation_nanoseconds_per_element(stream<T> s) {
+	constexpr uint64_t samples = 4096;
+	static std::mutex mutex;
+	static std::map<std::string, double> per_element;
+	{
+		std::lock_guard lg(mutex);
+		if (const auto it = per_element.find(s.name); it != per_element.end()) {
+			return it->second;
+		}
+	}
+	const timer t;
+	for (uint64_t i = 0; i < samples; ++i) {
+		s();
+	}
+	const auto nanoseconds = static_cast<double>(t.nanoseconds()) / static_cast<double>(samples);
+	std::lock_guard lg(mutex);
+	return per_element.try_emplace(s.name, nanoseconds).first->second;
+}
+
+// scales the generation time of the stream to all elements drawn by the job
+template <typename T>
+uint64_t estimate_generation_nanoseconds(const stream<T>& s, uint64_t elements) {
+	if (elements == 0) {
+		return 0;
+	}
+	return static_cast<uint64_t>(generation_nanoseconds_per_element(s) * static_cast<double>(elements));
+}
+
+// Runs the test and measures it. Only when profiling is the source wrapped to count the
+// elements the test draws, which the generation time estimate needs; otherwise the test
+// runs on the source itself and the elements are left 0.
+template <typename T>
+test_job_return run_instrumented(test_type type, bool profile, const stream<T>& source, const std::function<std::vector<test_result>(const stream<T>&)>& test) {
+	if (!profile) {
+		const timer wall;
+		const cpu_timer cpu;
+		auto results = test(source);
+		return {std::move(results), job_timing{type, source.name, static_cast<uint64_t>(wall.nanoseconds()), cpu.nanoseconds()}};
+	}
+	const auto elements = std::make_shared<uint64_t>(0);
+	const stream<T> counted{
+		source.name, [s = source, elements]() mutable {
+			++*elements;
+			return s();
+		}
+	};
+	perf_counters counters;
+	counters.start();
+	const timer wall;
+	const cpu_timer cpu;
+	auto results = test(counted);
+	job_timing timing{type, source.name, static_cast<uint64_t>(wall.nanoseconds()), cpu.nanoseconds(), *elements};
+	timing.perf = counters.stop();
+	timing.generation_nanoseconds = estimate_generation_nanoseconds(source, *elements);
+	return {std::move(results), timing};
+}
+
 template <typename T>
 test_job create_mixer_job(
 	uint64_t n,
 	const std::string& name,
 	const mixer<T>& mix,
 	const test_definition<T>& test_def,
-	const stream<T>& source) {
-	return [test_def, source, mix, name, n]()-> test_job_return {
-		std::vector<test_result> results;
-		for (const auto& sub_test : test_def.test_mixer(n, source, mix)) {
-			if (const auto& stat = sub_test.stats) {
-				results.push_back({source.name, name, n, {test_def.type, sub_test.name}, *stat});
+	const stream<T>& source,
+	bool profile) {
+	return [test_def, source, mix, name, n, profile]()-> test_job_return {
+		return run_instrumented<T>(test_def.type, profile, source, [&](const stream<T>& counted) {
+			std::vector<test_result> results;
+			for (const auto& sub_test : test_def.test_mixer(n, counted, mix)) {
+				if (const auto& stat = sub_test.stats) {
+					results.push_back({source.name, name, n, {test_def.type, sub_test.name}, *stat});
+				}
 			}
-		}
-		return results;
+			return results;
+		});
 	};
 }
 
 template <typename T>
-test_job create_stream_job(uint64_t n, const std::string& name, const test_definition<T>& test_def, const stream<T>& source) {
-	return [test_def, source, n, name]()-> test_job_return {
-		std::vector<test_result> results;
-		for (const auto& sub_test : test_def.test_stream(n, source)) {
-			if (const auto& stat = sub_test.stats) {
-				results.push_back(test_result{source.name, name, n, {test_def.type, sub_test.name}, *stat});
+test_job create_stream_job(uint64_t n, const std::string& name, const test_definition<T>& test_def, const stream<T>& source, bool profile) {
+	return [test_def, source, n, name, profile]()-> test_job_return {
+		return run_instrumented<T>(test_def.type, profile, source, [&](const stream<T>& counted) {
+			std::vector<test_result> results;
+			for (const auto& sub_test : test_def.test_stream(n, counted)) {
+				if (const auto& stat = sub_test.stats) {
+					results.push_back(test_result{source.name, name, n, {test_def.type, sub_test.name}, *stat});
+				}
 			}
-		}
-		return results;
+			return results;
+		});
 	};
 }
 
-template <typename T>
-test_jobs create_test_jobs(const uint64_t n, const test_setup<T>& setup) {
+struct typed_test_job {
+	test_type type;
+	test_job job;
+};
+
+using typed_test_jobs = std::vector<typed_test_job>;
+
+inline test_jobs to_test_jobs(const typed_test_jobs& typed_jobs) {
 	test_jobs jobs;
+	jobs.reserve(typed_jobs.size());
+	for (const auto& tj : typed_jobs) {
+		jobs.push_back(tj.job);
+	}
+	return jobs;
+}
+
+template <typename T>
+typed_test_jobs create_test_jobs(const uint64_t n, const test_setup<T>& setup) {
+	typed_test_jobs jobs;
 	const auto& test_subject_name = setup.test_subject_name;
 	const auto& mix = setup.mix;
 	for (const auto& test : setup.tests) {
@@ -85,27 +195,82 @@ test_jobs create_test_jobs(const uint64_t n, const test_setup<T>& setup) {
 		for (const auto& source : setup.sources) {
 			if (test_def.test_mixer && mix) {
 				// mixer test
-				jobs.push_back(create_mixer_job<T>(n, test_subject_name, *mix, test_def, source));
+				jobs.push_back({test, create_mixer_job<T>(n, test_subject_name, *mix, test_def, source, setup.profile)});
 			}
 			if (test_def.test_stream) {
 				// stream test
 				const auto s = create_stream(mix, source);
-				jobs.push_back(create_stream_job<T>(n, test_subject_name, test_def, s));
+				jobs.push_back({test, create_stream_job<T>(n, test_subject_name, test_def, s, setup.profile)});
 			}
 		}
 	}
 	return jobs;
 }
 
+template <typename ReturnT>
+struct cost_job {
+	double nanoseconds;
+	job<ReturnT> cost_job;
+};
+
+// wraps the job to refine the cost model with its measured run time
+inline cost_job<test_job_return> create_cost_job(const typed_test_job& tj, int bits, uint64_t n) {
+	return {
+		get_cost_model().predict_nanoseconds(tj.type, bits, n),
+		[tj, bits, n] {
+			auto r = tj.job();
+			get_cost_model().record(tj.type, bits, n, r.timing.wall_nanoseconds);
+			return r;
+		}
+	};
+}
+
+// Runs the longest predicted job first. run_jobs takes jobs from the back, the longest job is
+// placed last; a pool gets the costs to order them with the jobs of other callers.
+template <typename ReturnT>
+void run_longest_first(std::vector<cost_job<ReturnT>> cost_jobs, const std::function<void(const ReturnT&)>& collector, const std::shared_ptr<job_pool>& pool, unsigned int max_threads) {
+	std::stable_sort(cost_jobs.begin(), cost_jobs.end(), [](const cost_job<ReturnT>& a, const cost_job<ReturnT>& b) {
+		return a.nanoseconds < b.nanoseconds;
+	});
+	jobs<ReturnT> ordered;
+	std::vector<double> costs;
+	ordered.reserve(cost_jobs.size());
+	costs.reserve(cost_jobs.size());
+	for (const auto& cj : cost_jobs) {
+		ordered.push_back(cj.cost_job);
+		costs.push_back(cj.nanoseconds);
+	}
+	if (pool) {
+		pool->run<ReturnT>(ordered, collector, costs);
+	}
+	else {
+		run_jobs<ReturnT>(ordered, collector, max_threads);
+	}
+}
+
+template <typename ReturnT>
+uint64_t predict_milliseconds(const std::vector<cost_job<ReturnT>>& cost_jobs, unsigned int threads) {
+	std::vector<double> costs;
+	costs.reserve(cost_jobs.size());
+	for (const auto& cj : cost_jobs) {
+		costs.push_back(cj.nanoseconds);
+	}
+	return static_cast<uint64_t>(predict_makespan(costs, threads) / 1e6);
+}
+
+template <typename T>
+unsigned int get_thread_count(const test_setup<T>& setup) {
+	return setup.pool ? setup.pool->size() : setup.max_threads;
+}
+
 inline auto create_collector(test_battery_result& test_result) {
-	return [&](const test_job_return& results) {
-		if (!results.empty()) {
-			static std::mutex m;
-			std::lock_guard lg(m);
-			for (const auto& r : results) {
-				test_result.add(r);
-			}
+	return [&](const test_job_return& job_result) {
+		static std::mutex m;
+		std::lock_guard lg(m);
+		for (const auto& r : job_result.results) {
+			test_result.add(r);
 		}
+		test_result.job_timings.push_back(job_result.timing);
 	};
 }
 }
@@ -114,13 +279,90 @@ template <typename T>
 test_battery_result evaluate(uint64_t n, const test_setup<T>& setup) {
 	using namespace internal;
 	test_battery_result test_result{setup.test_subject_name, n, setup.sources.size(), bit_sizeof<T>()};
-	const auto jobs = create_test_jobs(n, setup);
+	std::vector<cost_job<test_job_return>> cost_jobs;
+	for (const auto& tj : create_test_jobs(n, setup)) {
+		cost_jobs.push_back(create_cost_job(tj, bit_sizeof<T>(), n));
+	}
+	test_result.threads = get_thread_count(setup);
+	test_result.predicted_milliseconds = predict_milliseconds(cost_jobs, test_result.threads);
 	const timer timer;
-	run_jobs<test_job_return>(jobs, create_collector(test_result), setup.max_threads);
+	run_longest_first<test_job_return>(cost_jobs, create_collector(test_result), setup.pool, setup.max_threads);
 	test_result.passed_milliseconds = timer.milliseconds();
 	return test_result;
 }
 
+// Measures one job per test of the setup at two powers of two and fits the cost model.
+template <typename T>
+void calibrate_cost_model(const test_setup<T>& setup, int low_power = 16, int high_power = 19) {
+	assertion(!setup.sources.empty(), "calibration requires a source");
+	auto single_source = setup;
+	single_source.sources = {setup.sources.front()};
+	const auto measure = [&single_source](uint64_t n) {
+		std::map<test_type, uint64_t> nanoseconds;
+		for (const auto& tj : internal::create_test_jobs(n, single_source)) {
+			const timer t;
+			tj.job();
+			nanoseconds[tj.type] += t.nanoseconds();
+		}
+		return nanoseconds;
+	};
+	const uint64_t n1 = 1ull << low_power;
+	const uint64_t n2 = 1ull << high_power;
+	const auto low = measure(n1);
+	const auto high = measure(n2);
+	for (const auto& e : high) {
+		get_cost_model().calibrate(e.first, bit_sizeof<T>(), n1, low.at(e.first), n2, e.second);
+	}
+}
+
+namespace internal {
+template <typename T>
+uint64_t get_fingerprint(const test_setup<T>& setup) {
+	// identifies the test subject by its output rather than its name only
+	constexpr int samples = 64;
+	hasher h;
+	h.add(result_cache::version).add(bit_sizeof<T>()).add(setup.test_subject_name);
+	for (const auto type : setup.tests) {
+		h.add(type);
+	}
+	if (const auto& mix = setup.mix) {
+		for (int i = 0; i < samples; ++i) {
+			h.add((*mix)(static_cast<T>(i)));
+		}
+	}
+	for (const auto& source : setup.sources) {
+		h.add(source.name);
+		auto s = create_stream(setup.mix, source);
+		for (int i = 0; i < samples; ++i) {
+			h.add(s());
+		}
+	}
+	return h.get();
+}
+
+inline std::string get_cache_key(const std::string& test_subject_name, int bits, uint64_t fingerprint, uint64_t n) {
+	std::string name;
+	for (const char c : test_subject_name) {
+		name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+	}
+	return name + "-" + std::to_string(bits) + "-" + to_hex(fingerprint) + "-" + std::to_string(n);
+}
+
+template <typename T>
+test_battery_result evaluate_cached(uint64_t n, const test_setup<T>& setup, uint64_t fingerprint) {
+	if (!setup.cache) {
+		return evaluate(n, setup);
+	}
+	const auto key = get_cache_key(setup.test_subject_name, bit_sizeof<T>(), fingerprint, n);
+	if (auto cached = setup.cache->load(key)) {
+		return *cached;
+	}
+	auto result = evaluate(n, setup);
+	setup.cache->store(key, result);
+	return result;
+}
+}
+
 using test_callback = std::function<bool(test_battery_result, bool last)>;
 
 template <typename T>
@@ -128,9 +370,10 @@ test_battery_result evaluate_multi_pass(const test_callback& result_callback,
                                         const test_setup<T>& setup) {
 	assertion(setup.start_power_of_two <= setup.stop_power_of_two, "start stop power of to not valid");
 	int power = setup.start_power_of_two;
+	const uint64_t fingerprint = setup.cache ? internal::get_fingerprint(setup) : 0;
 	test_battery_result result = {};
 	while (power <= setup.stop_power_of_two) {
-		result = evaluate(1ull << power, setup);
+		result = internal::evaluate_cached(1ull << power, setup, fingerprint);
 		if (!result_callback(result, power == setup.stop_power_of_two)) {
 			return result;
 		}
@@ -138,4 +381,92 @@ test_battery_result evaluate_multi_pass(const test_callback& result_callback,
 	}
 	return result;
 }
+// Evaluates many setups together one power of two at a time, only the setups whose callback
+// asks to proceed are raised to the next power. All jobs of a power are run in one batch,
+// longest predicted first, so that subjects failing early never hold on to threads at the
+// expensive high powers. Returns the last result of every setup.
+template <typename T>
+std::vector<test_battery_result> evaluate_breadth_first(const test_callback& result_callback,
+                                                        const std::vector<test_setup<T>>& setups) {
+	using namespace internal;
+	struct active_setup {
+		std::size_t index;
+		uint64_t fingerprint;
+	};
+	using indexed_job_return = std::pair<std::size_t, test_job_return>;
+
+	std::vector<test_battery_result> results(setups.size());
+	std::vector<active_setup> active;
+	int power = 63;
+	for (std::size_t i = 0; i < setups.size(); ++i) {
+		const auto& setup = setups[i];
+		assertion(setup.start_power_of_two <= setup.stop_power_of_two, "start stop power of to not valid");
+		active.push_back({i, setup.cache ? get_fingerprint(setup) : 0});
+		power = std::min(power, setup.start_power_of_two);
+	}
+
+	while (!active.empty()) {
+		const uint64_t n = 1ull << power;
+		std::vector<test_battery_result> pass(setups.size());
+		std::vector<bool> evaluated(setups.size());
+		std::vector<cost_job<indexed_job_return>> cost_jobs;
+		for (const auto& a : active) {
+			const auto& setup = setups[a.index];
+			if (power < setup.start_power_of_two) {
+				continue;
+			}
+			if (setup.cache) {
+				if (auto cached = setup.cache->load(get_cache_key(setup.test_subject_name, bit_sizeof<T>(), a.fingerprint, n))) {
+					pass[a.index] = *cached;
+					continue;
+				}
+			}
+			pass[a.index] = {setup.test_subject_name, n, setup.sources.size(), bit_sizeof<T>()};
+			evaluated[a.index] = true;
+			for (const auto& tj : create_test_jobs(n, setup)) {
+				const auto cj = create_cost_job(tj, bit_sizeof<T>(), n);
+				cost_jobs.push_back({
+					cj.nanoseconds,
+					[index = a.index, job = cj.cost_job] { return std::make_pair(index, job()); }
+				});
+			}
+		}
+
+		const auto& first = setups[active.front().index];
+		const auto predicted_milliseconds = predict_milliseconds(cost_jobs, get_thread_count(first));
+		const auto collector = [&pass](const indexed_job_return& r) {
+			create_collector(pass[r.first])(r.second);
+		};
+		const timer timer;
+		run_longest_first<indexed_job_return>(cost_jobs, collector, first.pool, first.max_threads);
+		const auto milliseconds = timer.milliseconds();
+
+		std::vector<active_setup> proceeding;
+		for (const auto& a : active) {
+			const auto& setup = setups[a.index];
+			if (power < setup.start_power_of_two) {
+				proceeding.push_back(a);
+				continue;
+			}
+			auto& result = pass[a.index];
+			if (evaluated[a.index]) {
+				// the wall time of the whole batch, shared by all setups in it
+				result.passed_milliseconds = milliseconds;
+				result.predicted_milliseconds = predicted_milliseconds;
+				result.threads = get_thread_count(first);
+				if (setup.cache) {
+					setup.cache->store(get_cache_key(setup.test_subject_name, bit_sizeof<T>(), a.fingerprint, n), result);
+				}
+			}
+			results[a.index] = result;
+			const bool is_last = power == setup.stop_power_of_two;
+			if (result_callback(result, is_last) && !is_last) {
+				proceeding.push_back(a);
+			}
+		}
+		active = proceeding;
+		++power;
+	}
+	return results;
+}
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_definitions.h"
+#include "util/json.h"
+
+namespace tfr {
+
+inline std::string to_string(statistic_type type) {
+	switch (type) {
+	case statistic_type::z_score: return "z-score";
+	case statistic_type::chi2: return "chi2";
+	case statistic_type::kolmogorov_smirnov_d: return "kolmogorov-smirnov-d";
+	case statistic_type::anderson_darling_A2: return "anderson-darling-a2";
+	}
+	assertion(false, "unknown statistic type");
+	return "unknown";
+}
+
+inline json_object to_json(const statistic& stat) {
+	return json_object()
+	       .add("type", to_string(stat.type))
+	       .add("value", stat.value)
+	       .add("p_value", stat.p_value)
+	       .add("df", stat.df);
+}
+
+inline json_object to_json(const test_battery_result& br, const test_result& r) {
+	return json_object()
+	       .add("subject", br.test_subject_name)
+	       .add("bits", br.bits)
+	       .add("power_of_two", br.power_of_two())
+	       .add("stream", r.stream_name.str())
+	       .add("test", get_test_name(r.key.type))
+	       .add("sub_test", r.key.sub_test_name.str())
+	       .add("n", r.n)
+	       .add("statistic", to_json(r.stats))
+	       .add("battery_milliseconds", br.passed_milliseconds)
+	       .add("predicted_battery_milliseconds", br.predicted_milliseconds);
+}
+
+inline json_object to_json(const perf_sample& perf) {
+	return json_object()
+	       .add("cycles", perf.cycles)
+	       .add("instructions", perf.instructions)
+	       .add("cache_misses", perf.cache_misses)
+	       .add("branch_misses", perf.branch_misses);
+}
+
+inline json_object to_json(const test_battery_result& br, const job_timing& t) {
+	auto json = json_object()
+	       .add("subject", br.test_subject_name)
+	       .add("bits", br.bits)
+	       .add("power_of_two", br.power_of_two())
+	       .add("stream", t.stream_name)
+	       .add("test", get_test_name(t.type))
+	       .add("wall_nanoseconds", t.wall_nanoseconds)
+	       .add("cpu_nanoseconds", t.cpu_nanoseconds)
+	       .add("elements", t.elements)
+	       .add("generation_nanoseconds", t.generation_nanoseconds)
+	       .add("kernel_nanoseconds", t.kernel_nanoseconds())
+	       .add("threads", static_cast<uint64_t>(br.threads))
+	       .add("thread_utilization", br.thread_utilization());
+	if (t.perf) {
+		json.add("perf", to_json(*t.perf));
+	}
+	return json;
+}
+
+// one json object per line (json lines), one line per test result, the tests ordered by name
+inline std::string to_json_lines(const test_battery_result& br) {
+	std::vector<const test_battery_result::test_result_map::value_type*> entries;
+	for (const auto& e : br.results) {
+		entries.push_back(&e);
+	}
+	std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) {
+		return a->first.less_by_name(b->first);
+	});
+	std::string lines;
+	for (const auto* e : entries) {
+		for (const auto& r : e->second) {
+			lines += to_json(br, r).to_string() + "\n";
+		}
+	}
+	return lines;
+}
+
+// one line per job timing
+inline std::string to_json_timing_lines(const test_battery_result& br) {
+	std::string lines;
+	for (const auto& t : br.job_timings) {
+		lines += to_json(br, t).to_string() + "\n";
+	}
+	return lines;
+}
+
+}
@@ -32,7 +32,7 @@ inline void draw_histogram_rescale(const std::vector<double>& data) {
 }
 
 inline std::string to_string(const test_key& key) {
-	return get_test_name(key.type) + (key.sub_test_name.empty() ? "" : ":" + key.sub_test_name);
+	return get_test_name(key.type) + (key.sub_test_name.empty() ? "" : ":" + key.sub_test_name.str());
 }
 
 inline std::string to_string(const seed_data& seed) {
@@ -108,13 +108,73 @@ inline std::vector<std::string> get_failed_tests(const std::vector<result_analys
 	return result;
 }
 
+inline std::string to_string(const std::string& title, const std::vector<std::pair<std::string, job_totals>>& totals) {
+	const bool profiled = std::any_of(totals.begin(), totals.end(), [](const auto& e) { return e.second.profiled_jobs > 0; });
+	// elements are only counted when profiling
+	const bool counted = std::any_of(totals.begin(), totals.end(), [](const auto& e) { return e.second.elements > 0; });
+	std::vector<std::string> headers{title, "jobs", "wall ms", "cpu ms"};
+	if (counted) {
+		headers.insert(headers.end(), {"elements", "ns/element", "generation"});
+	}
+	if (profiled) {
+		headers.insert(headers.end(), {"ipc", "cache misses/element", "branch misses/element"});
+	}
+	table t(headers);
+	for (const auto& e : totals) {
+		const auto& sum = e.second;
+		if (counted && sum.elements == 0) {
+			// skipped for this n
+			continue;
+		}
+		t.col(e.first)
+		 .col(sum.jobs)
+		 .col(sum.wall_nanoseconds / 1000000)
+		 .col(sum.cpu_nanoseconds / 1000000);
+		if (counted) {
+			const auto generation_percent = sum.wall_nanoseconds > 0 ? 100 * std::min(sum.generation_nanoseconds, sum.wall_nanoseconds) / sum.wall_nanoseconds : 0;
+			t.col(sum.elements)
+			 .col(sum.wall_nanoseconds / sum.elements)
+			 .col(std::to_string(generation_percent) + "%");
+		}
+		if (profiled) {
+			const auto elements = static_cast<double>(sum.elements);
+			t.col(sum.perf.instructions_per_cycle())
+			 .col(static_cast<double>(sum.perf.cache_misses) / elements)
+			 .col(static_cast<double>(sum.perf.branch_misses) / elements);
+		}
+		t.row();
+	}
+	return t.to_string();
+}
+
+// run time per test summed over its jobs, not shown for cached results
+inline void print_job_timings(const test_battery_result& battery_result) {
+	if (battery_result.job_timings.empty()) {
+		return;
+	}
+	std::map<test_type, job_totals> per_test;
+	for (const auto& t : battery_result.job_timings) {
+		per_test[t.type].add(t);
+	}
+	std::vector<std::pair<std::string, job_totals>> totals;
+	for (const auto& e : per_test) {
+		totals.emplace_back(get_test_name(e.first), e.second);
+	}
+	std::cout << to_string("test", totals);
+	std::cout << "Thread utilization " << static_cast<int>(100 * battery_result.thread_utilization()) << "% of " << battery_result.threads << " threads.\n\n";
+}
+
 inline void print_battery_result(const test_battery_result& battery_result) {
 	std::cout << "==========================================================================================\n";
 	std::cout
 		<< battery_result.test_subject_name
 		<< " 2^" << battery_result.power_of_two()
 		<< " with " << battery_result.samples << " samples using "
-		<< battery_result.bits << "-bits (" << battery_result.passed_milliseconds / 1000 << "s)\n";
+		<< battery_result.bits << "-bits (" << battery_result.passed_milliseconds / 1000 << "s";
+	if (battery_result.predicted_milliseconds > 0) {
+		std::cout << ", predicted " << battery_result.predicted_milliseconds / 1000 << "s";
+	}
+	std::cout << ")\n";
 	std::cout << join(get_tests(battery_result), ",") << "\n";
 	std::cout << "==========================================================================================\n";
 
@@ -142,5 +202,6 @@ inline void print_battery_result(const test_battery_result& battery_result) {
 		std::cout << failures << " failures and " << suspicious << " suspicious results.\n";
 		std::cout << "\n";
 	}
+	print_job_timings(battery_result);
 }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,10 +13,22 @@ struct mixer {
 
 	std::string name;
 	std::function<T(T)> mix;
+	// optional, mixes all values in place with the same result as mix
+	std::function<void(std::span<T>)> mix_block{};
 
 	T operator()(T x) const {
 		return mix(x);
 	}
+
+	void operator()(std::span<T> values) const {
+		if (mix_block) {
+			mix_block(values);
+			return;
+		}
+		for (auto& x : values) {
+			x = mix(x);
+		}
+	}
 };
 
 template <typename T> std::vector<mixer<T>> get_mixers() = delete;
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_definitions.h"
+#include "util/fileutil.h"
+
+namespace tfr {
+namespace detail {
+inline std::vector<std::string> split(const std::string& line, char delimiter) {
+	std::vector<std::string> parts;
+	std::string part;
+	std::istringstream iss(line);
+	while (std::getline(iss, part, delimiter)) {
+		parts.push_back(part);
+	}
+	if (!line.empty() && line.back() == delimiter) {
+		parts.emplace_back();
+	}
+	return parts;
+}
+
+// false unless all of the text is a number
+template <typename T>
+bool parse_cache_number(const std::string& text, T& value) {
+	const auto* end = text.data() + text.size();
+	const auto r = std::from_chars(text.data(), end, value);
+	return r.ec == std::errc() && r.ptr == end;
+}
+
+// names are stored between tabs, one result per line
+inline bool is_cacheable_name(std::string_view name) {
+	return name.find_first_of("\t\n\r") == std::string_view::npos;
+}
+
+inline std::string to_cache_string(double d) {
+	std::ostringstream oss;
+	oss << std::setprecision(17) << d;
+	return oss.str();
+}
+}
+
+// Stores one test_battery_result per file, the key should identify everything that
+// could change the result (subject, implementation, tests, sources and n).
+class result_cache {
+public:
+	static constexpr int version = 1;
+
+	explicit result_cache(std::string dir) : _dir(std::move(dir)) {
+		create_directories(_dir);
+	}
+
+	std::optional<test_battery_result> load(const std::string& key) const {
+		std::ifstream file(get_path(key));
+		if (!file.good()) {
+			return {};
+		}
+		std::string line;
+		if (!std::getline(file, line) || line != header()) {
+			return {};
+		}
+		if (!std::getline(file, line)) {
+			return {};
+		}
+		const auto battery = detail::split(line, '\t');
+		if (battery.size() != 5) {
+			return {};
+		}
+		// a truncated or corrupt entry is recomputed
+		uint64_t n{};
+		uint64_t samples{};
+		int bits{};
+		uint64_t passed_milliseconds{};
+		if (!detail::parse_cache_number(battery[1], n) || !detail::parse_cache_number(battery[2], samples)
+			|| !detail::parse_cache_number(battery[3], bits) || !detail::parse_cache_number(battery[4], passed_milliseconds)) {
+			return {};
+		}
+		test_battery_result br{battery[0], n, samples, bits};
+		br.passed_milliseconds = passed_milliseconds;
+
+		while (std::getline(file, line)) {
+			const auto r = detail::split(line, '\t');
+			if (r.size() != 9) {
+				return {};
+			}
+			const auto type = find_test_type(r[3]);
+			if (!type) {
+				return {};
+			}
+			uint64_t result_n{};
+			int stat_type{};
+			double value{};
+			double p_value{};
+			double df{};
+			if (!detail::parse_cache_number(r[2], result_n) || !detail::parse_cache_number(r[5], stat_type) || !detail::parse_cache_number(r[6], value)
+				|| !detail::parse_cache_number(r[7], p_value) || !detail::parse_cache_number(r[8], df)) {
+				return {};
+			}
+			const statistic stat{static_cast<statistic_type>(stat_type), value, p_value, df};
+			br.add({r[0], r[1], result_n, {*type, r[4]}, stat});
+		}
+		return br;
+	}
+
+	// results with a tab or newline in a name are not cached
+	void store(const std::string& key, const test_battery_result& br) const {
+		if (!detail::is_cacheable_name(br.test_subject_name)) {
+			return;
+		}
+		for (const auto& e : br.results) {
+			if (!detail::is_cacheable_name(e.first.sub_test_name.str())) {
+				return;
+			}
+			for (const auto& r : e.second) {
+				if (!detail::is_cacheable_name(r.stream_name.str()) || !detail::is_cacheable_name(r.mixer_name.str())) {
+					return;
+				}
+			}
+		}
+		std::ostringstream os;
+		os << header() << "\n";
+		os << br.test_subject_name << "\t" << br.n << "\t" << br.samples << "\t" << br.bits << "\t" << br.passed_milliseconds << "\n";
+		for (const auto& e : br.results) {
+			for (const auto& r : e.second) {
+				os << r.stream_name << "\t" << r.mixer_name << "\t" << r.n << "\t"
+					<< get_test_name(r.key.type) << "\t" << r.key.sub_test_name << "\t"
+					<< static_cast<int>(r.stats.type) << "\t"
+					<< detail::to_cache_string(r.stats.value) << "\t"
+					<< detail::to_cache_string(r.stats.p_value) << "\t"
+					<< detail::to_cache_string(r.stats.df) << "\n";
+			}
+		}
+		// write and rename so that an interrupted run never leaves a truncated entry
+		const auto path = get_path(key);
+		const auto tmp_path = path + ".tmp";
+		if (write(tmp_path, os.str())) {
+			std::filesystem::rename(tmp_path, path);
+		}
+	}
+
+	std::string get_path(const std::string& key) const {
+		return _dir + key + ".tsv";
+	}
+
+private:
+	static std::string header() {
+		return "tfr-result-cache\t" + std::to_string(version);
+	}
+
+	std::string _dir;
+};
+
+}
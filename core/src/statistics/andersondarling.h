@@ -1,27 +1,62 @@
 #pragma once
 
 #include <algorithm>
+#include <span>
 #include <vector>
 
 #include "distributions.h"
+#include "p_value_histogram.h"
 #include "types.h"
 
 namespace tfr {
 
-inline std::optional<statistic> anderson_darling_stats(std::vector<double> data01) {
-	if (data01.empty()) {
+// the data has to be sorted, e.g. the values of an exact p_value_histogram
+inline std::optional<statistic> anderson_darling_stats_sorted(std::span<const double> sorted01) {
+	if (sorted01.empty()) {
 		return {};
 	}
-	std::sort(data01.begin(), data01.end());
+	assertion(std::is_sorted(sorted01.begin(), sorted01.end()), "anderson darling data not sorted");
 	double sum = 0;
-	for (std::size_t i = 0; i < data01.size(); ++i) {
-		assertion(is_valid_between_01(data01[i]), "anderson darling data not 0-1 or invalid");
-		const double a = data01[i];
-		const double b = data01[data01.size() - 1 - i];
+	for (std::size_t i = 0; i < sorted01.size(); ++i) {
+		assertion(is_valid_between_01(sorted01[i]), "anderson darling data not 0-1 or invalid");
+		const double a = sorted01[i];
+		const double b = sorted01[sorted01.size() - 1 - i];
 		sum += (2. * i + 1.) * (log_safe(a) + log_safe(1. - b));
 	}
 
-	const auto n = static_cast<double>(data01.size());
+	const auto n = static_cast<double>(sorted01.size());
+	const auto A2 = -n - sum / n;
+	return statistic{statistic_type::anderson_darling_A2, A2, anderson_darling_cdf(A2, n), n};
+}
+
+inline std::optional<statistic> anderson_darling_stats(std::vector<double> data01) {
+	std::sort(data01.begin(), data01.end());
+	return anderson_darling_stats_sorted(data01);
+}
+
+// the sum above rewritten per value: rank i weights log(p) with 2i + 1 and log(1 - p) with 2(n - i) - 1
+inline std::optional<statistic> anderson_darling_stats(const p_value_histogram& histogram) {
+	if (histogram.empty()) {
+		return {};
+	}
+	if (histogram.exact()) {
+		return anderson_darling_stats_sorted(histogram.values());
+	}
+	const auto n = static_cast<double>(histogram.size());
+	double sum = 0;
+	const double width = histogram.bin_width();
+	histogram.for_each_bin([&](const p_value_histogram::bin& b, uint64_t rank, double) {
+		// Within the bin the value with the k-th smallest p has rank + k. The sum over k log(p)
+		// is the average k times the sum of log(p) plus how k and log(p) covary, with k taken to
+		// grow by count / width with p. Exact with one value per bin.
+		const auto count = static_cast<double>(b.count);
+		const auto slope = count / width;
+		const auto k_log = (count - 1) / 2 * b.sum_log + slope * (b.sum_p_log - b.sum_p * b.sum_log / count);
+		const auto k_log_complement = (count - 1) / 2 * b.sum_log_complement + slope * (b.sum_p_log_complement - b.sum_p * b.sum_log_complement / count);
+		const auto r = static_cast<double>(rank);
+		sum += (2 * r + 1) * b.sum_log + 2 * k_log;
+		sum += (2 * (n - r) - 1) * b.sum_log_complement - 2 * k_log_complement;
+	});
 	const auto A2 = -n - sum / n;
 	return statistic{statistic_type::anderson_darling_A2, A2, anderson_darling_cdf(A2, n), n};
 }
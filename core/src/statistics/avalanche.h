@@ -51,6 +51,19 @@ std::optional<statistic> avalanche_sac_stats(const double n, const std::vector<u
 	}, 5.);
 }
 
+// mean distance of the flipped bit counts from half the bits, 0 is ideal and 1 is no avalanche at
+// all; a random function is around 0.14 for 32 bits, unlike the p value it orders broken mixers
+inline double avalanche_sac_bias(const std::vector<uint64_t>& bit_counts) {
+	const double half = static_cast<double>(bit_counts.size() - 1) / 2;
+	double total = 0;
+	double distance = 0;
+	for (std::size_t k = 0; k < bit_counts.size(); ++k) {
+		total += static_cast<double>(bit_counts[k]);
+		distance += static_cast<double>(bit_counts[k]) * std::abs(static_cast<double>(k) - half);
+	}
+	return total > 0 ? distance / (total * half) : 1.;
+}
+
 inline std::optional<statistic> avalanche_bic_stats(const double n, const std::vector<uint64_t>& bit_counts) {
 	return chi2_stats(bit_counts.size(),
 	                  mul(to_data(bit_counts), to_data(2)), to_data(n));
@@ -5,6 +5,7 @@
 
 #include "chi2.h"
 #include "util/bitwise.h"
+#include "util/memoize.h"
 #include "types.h"
 
 namespace tfr {
@@ -66,7 +67,8 @@ inline double get_rank_probability(uint64_t matrix_size, uint64_t rank) {
 	return c * p;
 }
 
-inline std::vector<double> get_rank_probabilities(uint64_t matrix_size) {
+namespace detail {
+inline std::vector<double> compute_rank_probabilities(uint64_t matrix_size) {
 	std::deque<double> probabilities;
 	uint64_t rank = 0;
 	double sum = 0;
@@ -79,10 +81,16 @@ inline std::vector<double> get_rank_probabilities(uint64_t matrix_size) {
 	assertion(is_near(sum, 1), "Unexpected sum for rank probabilities");
 	return {probabilities.begin(), probabilities.end()};
 }
+}
+
+inline const std::vector<double>& get_rank_probabilities(uint64_t matrix_size) {
+	static const memoized<uint64_t, std::vector<double>> table(detail::compute_rank_probabilities);
+	return table(matrix_size);
+}
 
 template <typename T>
 std::optional<statistic> binary_rank_stats(uint64_t n, stream<T> stream, uint64_t matrix_size) {
-	const auto ps = get_rank_probabilities(matrix_size);
+	const auto& ps = get_rank_probabilities(matrix_size);
 	std::vector<uint64_t> rank_counts(ps.size(), 0);
 	uint64_t blocks = 0;
 	for_each_matrix(ranged_stream<T>(stream, n), matrix_size,
@@ -99,7 +107,7 @@ std::optional<statistic> binary_rank_stats(uint64_t n, stream<T> stream, uint64_
 template <typename T>
 std::optional<statistic> binary_rank_isolated_bit_stats(uint64_t n, stream<T> stream, uint64_t matrix_size, int bit) {
 	const auto blocks = bit_sizeof<T>() * n / (matrix_size * matrix_size);
-	const auto ps = get_rank_probabilities(matrix_size);
+	const auto& ps = get_rank_probabilities(matrix_size);
 	std::vector<uint64_t> rank_counts(ps.size(), 0);
 	for (uint64_t block = 0; block < blocks; ++block) {
 		binary_square_matrix bits(matrix_size);
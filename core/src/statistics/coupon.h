@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <set>
 #include <vector>
 
@@ -7,6 +8,7 @@
 #include "types.h"
 #include "streams.h"
 #include "util/algo.h"
+#include "util/memoize.h"
 
 namespace tfr {
 template <typename T>
@@ -33,22 +35,51 @@ std::vector<uint64_t> collect_coupons(uint64_t wanted_coupons, uint64_t tracked_
 	return draws_histogram;
 }
 
-inline std::vector<double> expected_probabilities(const uint64_t wanted_coupons) {
+namespace detail {
+// usable at compile time, so no tgamma or pow
+constexpr std::vector<double> compute_coupon_probabilities(const uint64_t wanted_coupons) {
 	// from: https://www.cs.fsu.edu/~mascagni/Testing.pdf
+	double factorial = 1;
+	double power = 1;
+	for (uint64_t i = 1; i <= wanted_coupons; ++i) {
+		factorial *= static_cast<double>(i);
+		power *= static_cast<double>(wanted_coupons);
+	}
 	std::vector<double> expected;
-	const double fac_d = std::tgamma(wanted_coupons + 1);
 	double sum = 0;
 	auto i = wanted_coupons;
 	while (sum < 0.99 && i < 30) {
-		const double p = fac_d / pow(wanted_coupons, i) * stirling_second_kind(i - 1, wanted_coupons - 1);
-		assertion(is_valid_between_01(p), "unexpected coupon probability");
+		const double p = factorial / power * static_cast<double>(stirling_second_kind(static_cast<int>(i - 1), static_cast<int>(wanted_coupons - 1)));
 		expected.push_back(p);
 		sum += p;
+		power *= static_cast<double>(wanted_coupons);
 		++i;
 	}
 	expected.push_back(1. - sum);
 	return expected;
 }
+}
+
+inline const std::vector<double>& expected_probabilities(const uint64_t wanted_coupons) {
+	static const memoized<uint64_t, std::vector<double>> table([](uint64_t w) {
+		auto ps = detail::compute_coupon_probabilities(w);
+		for (std::size_t i = 0; i + 1 < ps.size(); ++i) {
+			assertion(is_valid_between_01(ps[i]), "unexpected coupon probability");
+		}
+		return ps;
+	});
+	return table(wanted_coupons);
+}
+
+// expected probabilities for a fixed number of coupons, computed at compile time
+template <uint64_t WantedCoupons>
+constexpr auto get_coupon_probability_table() {
+	constexpr auto size = detail::compute_coupon_probabilities(WantedCoupons).size();
+	std::array<double, size> table{};
+	const auto ps = detail::compute_coupon_probabilities(WantedCoupons);
+	std::copy(ps.begin(), ps.end(), table.begin());
+	return table;
+}
 
 inline double expected_draws_per_coupon(uint64_t wanted_coupons) {
 	// from: https://en.wikipedia.org/wiki/Coupon_collector%27s_problem
@@ -61,7 +92,7 @@ inline double expected_draws_per_coupon(uint64_t wanted_coupons) {
 template <typename T>
 std::optional<statistic> coupon_stats(uint64_t n, const T& data) {
 	constexpr uint64_t wanted_coupons = 5;
-	const auto ps = expected_probabilities(wanted_coupons);
+	static constexpr auto ps = get_coupon_probability_table<wanted_coupons>();
 	const auto cc = collect_coupons(wanted_coupons, ps.size(), data);
 	assertion(cc.size() == ps.size(), "Unexpected size in coupons");
 
@@ -32,17 +32,47 @@ inline double chi2_distribution_normal_approximation_cdf(double chi2, double df)
 	return 1 - normal_cdf(std::sqrt(2 * chi2) - std::sqrt(2 * df - 1));
 }
 
-inline double chi2_distribution_cdf(double chi2, double df) {
+// Wilson-Hilferty: (chi2 / df)^(1/3) is close to normal with mean 1 - 2 / (9 df) and variance
+// 2 / (9 df), the coefficients only depend on df and are computed once per df.
+class chi2_wilson_hilferty {
+public:
+	explicit chi2_wilson_hilferty(double df)
+		: _df(df), _mean(1. - 2. / (9. * df)), _inverse_sd_sqrt_2(1. / std::sqrt(4. / (9. * df))) {
+	}
+
+	double operator()(double chi2) const {
+		return .5 * std::erfc((std::cbrt(chi2 / _df) - _mean) * _inverse_sd_sqrt_2);
+	}
+
+private:
+	double _df;
+	double _mean;
+	double _inverse_sd_sqrt_2;
+};
+
+// from this df on the absolute error of wilson-hilferty is below ~1e-5 and the relative error
+// of small p-values a few percent, well within one failure strength level
+constexpr double chi2_wilson_hilferty_min_df = 1000;
+
+inline double chi2_distribution_wilson_hilferty_cdf(double chi2, double df) {
+	return chi2_wilson_hilferty(df)(chi2);
+}
+
+inline double chi2_distribution_gamma_cdf(double chi2, double df) {
 	// found here: https://en.wikipedia.org/wiki/Chi-squared_distribution
 	if (is_near(df, 0)) {
 		return 0;
 	}
-	if (df >= 1100000) {
-		return chi2_distribution_normal_approximation_cdf(chi2, df);
-	}
 	return gamma_regularized(.5 * df, .5 * chi2);
 }
 
+inline double chi2_distribution_cdf(double chi2, double df) {
+	if (df >= chi2_wilson_hilferty_min_df) {
+		return chi2_distribution_wilson_hilferty_cdf(chi2, df);
+	}
+	return chi2_distribution_gamma_cdf(chi2, df);
+}
+
 inline double beta(double a, double b) {
 	// return std::beta(a, b);
 	return exp(log_gamma(a) + log_gamma(b) - log_gamma(a + b));
@@ -7,6 +7,7 @@
 #include "distributions.h"
 #include "types.h"
 #include "util/algo.h"
+#include "util/memoize.h"
 
 namespace tfr {
 template <typename T>
@@ -32,7 +33,8 @@ std::vector<uint64_t> collect_divisible(uint64_t divisor, uint64_t wanted, uint6
 	return draws_histogram;
 }
 
-inline std::vector<double> divisible_expected_probabilities(const uint32_t divisor, const uint32_t wanted) {
+namespace detail {
+inline std::vector<double> compute_divisible_expected_probabilities(const uint32_t divisor, const uint32_t wanted) {
 	std::vector<double> expected;
 	double sum = 0;
 	uint32_t k = 0;
@@ -45,6 +47,14 @@ inline std::vector<double> divisible_expected_probabilities(const uint32_t divis
 	expected.push_back(1. - sum);
 	return expected;
 }
+}
+
+inline const std::vector<double>& divisible_expected_probabilities(const uint32_t divisor, const uint32_t wanted) {
+	static const memoized<std::pair<uint32_t, uint32_t>, std::vector<double>> table([](const std::pair<uint32_t, uint32_t>& key) {
+		return detail::compute_divisible_expected_probabilities(key.first, key.second);
+	});
+	return table({divisor, wanted});
+}
 
 template <typename T>
 sub_test_results divisibility_test(uint64_t n, const stream<T>& stream) {
@@ -52,7 +62,7 @@ sub_test_results divisibility_test(uint64_t n, const stream<T>& stream) {
 	// @attn: Using non power of two divisors gives significant bias for 8-bit streams
 	for (uint32_t divisor : {2}) {
 		constexpr auto wanted = 5;
-		const auto ps = divisible_expected_probabilities(divisor, wanted);
+		const auto& ps = divisible_expected_probabilities(divisor, wanted);
 		const auto collected = collect_divisible(divisor, wanted, ps.size(), ranged_stream(stream, n));
 		assertion(collected.size() == ps.size(), "Unexpected size in divisible");
 
@@ -7,6 +7,7 @@
 #include "streams.h"
 #include "types.h"
 #include "util/algo.h"
+#include "util/memoize.h"
 
 namespace tfr {
 template <typename T>
@@ -29,7 +30,8 @@ std::vector<uint64_t> generate_gaps(uint64_t max_gap_size, double a, double b, c
 	return gaps;
 }
 
-inline std::vector<double> generate_gap_probabilities(double a, double b) {
+namespace detail {
+inline std::vector<double> compute_gap_probabilities(double a, double b) {
 	std::vector<double> ps;
 	double p_sum = 0;
 	std::size_t i = 0;
@@ -42,6 +44,14 @@ inline std::vector<double> generate_gap_probabilities(double a, double b) {
 	assertion(is_valid_between_01(ps.back()), "Weird gap probabilities");
 	return ps;
 }
+}
+
+inline const std::vector<double>& generate_gap_probabilities(double a, double b) {
+	static const memoized<std::pair<double, double>, std::vector<double>> table([](const std::pair<double, double>& gap) {
+		return detail::compute_gap_probabilities(gap.first, gap.second);
+	});
+	return table({a, b});
+}
 
 template <typename T>
 sub_test_results gap_test(uint64_t n, const stream<T>& source) {
@@ -1,20 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
 #include <vector>
 
 #include "distributions.h"
+#include "p_value_histogram.h"
 #include "types.h"
 
 namespace tfr {
 
-inline std::optional<statistic> kolmogorov_smirnov_stats(std::vector<double> data01) {
-	std::sort(data01.begin(), data01.end());
-	const auto n = static_cast<double>(data01.size());
+// the data has to be sorted, e.g. the values of an exact p_value_histogram
+inline std::optional<statistic> kolmogorov_smirnov_stats_sorted(std::span<const double> sorted01) {
+	assertion(std::is_sorted(sorted01.begin(), sorted01.end()), "kolmogorov smirnov data not sorted");
+	const auto n = static_cast<double>(sorted01.size());
 	double max_distance = 0;
-	for (std::size_t i = 0; i < data01.size(); ++i) {
+	for (std::size_t i = 0; i < sorted01.size(); ++i) {
 		const double e0 = i / n;
 		const double e1 = (i + 1) / n;
-		const double d = data01[i];
+		const double d = sorted01[i];
 		const double distance = std::max(std::abs(e0 - d), std::abs(e1 - d));
 		max_distance = std::max(distance, max_distance);
 	}
@@ -22,4 +26,28 @@ inline std::optional<statistic> kolmogorov_smirnov_stats(std::vector<double> dat
 	return statistic{statistic_type::kolmogorov_smirnov_d, max_distance, p_value, n};
 }
 
+inline std::optional<statistic> kolmogorov_smirnov_stats(std::vector<double> data01) {
+	std::sort(data01.begin(), data01.end());
+	return kolmogorov_smirnov_stats_sorted(data01);
+}
+
+// linear in the number of bins, the values within a bin are bounded by its minimum and maximum
+inline std::optional<statistic> kolmogorov_smirnov_stats(const p_value_histogram& histogram) {
+	if (histogram.empty()) {
+		return {};
+	}
+	if (histogram.exact()) {
+		return kolmogorov_smirnov_stats_sorted(histogram.values());
+	}
+	const auto n = static_cast<double>(histogram.size());
+	double max_distance = 0;
+	histogram.for_each_bin([&](const p_value_histogram::bin& b, uint64_t rank, double) {
+		const double e0 = static_cast<double>(rank) / n;
+		const double e1 = static_cast<double>(rank + b.count) / n;
+		max_distance = std::max({max_distance, e1 - b.min, b.max - e0});
+	});
+	const auto p_value = kolmogorov_smirnov_cdf(max_distance, n, 100);
+	return statistic{statistic_type::kolmogorov_smirnov_d, max_distance, p_value, n};
+}
+
 }
@@ -4,6 +4,7 @@
 
 #include "chi2.h"
 #include "types.h"
+#include "util/memoize.h"
 
 namespace tfr {
 // from: https://github.com/google/paranoid_crypto/blob/main/paranoid_crypto/lib/randomness_tests/nist_suite.py
@@ -53,7 +54,8 @@ inline int berlekamp_massey(const std::vector<int>& u) {
 	return l;
 }
 
-inline std::vector<double> get_expected_probabilities(uint64_t block_size) {
+namespace detail {
+inline std::vector<double> compute_expected_probabilities(uint64_t block_size) {
 	std::vector<double> ps;
 	auto sum = 0.;
 	for (uint64_t l = 0; l <= block_size; ++l) {
@@ -62,10 +64,16 @@ inline std::vector<double> get_expected_probabilities(uint64_t block_size) {
 	assertion(is_near(sum, 1), "Unexpected sum in lfsr probabilities");
 	return ps;
 }
+}
+
+inline const std::vector<double>& get_expected_probabilities(uint64_t block_size) {
+	static const memoized<uint64_t, std::vector<double>> table(detail::compute_expected_probabilities);
+	return table(block_size);
+}
 
 template <typename T>
 std::optional<statistic> linear_complexity_stats(uint64_t n, stream<T> stream, uint64_t block_size, int bit = 0) {
-	const auto ps = get_expected_probabilities(block_size);
+	const auto& ps = get_expected_probabilities(block_size);
 	std::vector<uint64_t> counts(ps.size(), 0);
 
 	const auto blocks = n / block_size;
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "util/assertion.h"
+#include "util/math.h"
+
+namespace tfr {
+
+// Streaming summary of values in [0, 1] for Kolmogorov-Smirnov and Anderson-Darling. Up to
+// exact_limit values are kept sorted as they are added, the statistics are exact and need no
+// sort. Past that the values go into equal width bins which keep their count, minimum, maximum
+// and a few sums of p, log(p) and log(1 - p), so memory stays fixed however many values are
+// added. From the bins the KS distance is an upper bound, at most the largest bin share of the
+// values above the exact one, and AD estimates the ranks within a bin from the values, which is
+// off by about 0.01 for 1000 values per bin.
+class p_value_histogram {
+public:
+	static constexpr std::size_t default_bin_count = 1024;
+	static constexpr std::size_t default_exact_limit = 4096;
+
+	struct bin {
+		uint64_t count{};
+		double min = std::numeric_limits<double>::max();
+		double max{};
+		double sum_log{};
+		double sum_log_complement{};
+		// to estimate how the values and their logs covary within the bin
+		double sum_p{};
+		double sum_p_log{};
+		double sum_p_log_complement{};
+	};
+
+	explicit p_value_histogram(std::size_t bin_count) : _bin_count(bin_count) {
+		assertion(bin_count > 0, "p value histogram without bins");
+	}
+
+	// bins from the first value on, e.g. to compare the binned statistics with the exact ones
+	static p_value_histogram binned(std::size_t bin_count) {
+		p_value_histogram histogram(bin_count);
+		histogram._exact_limit = 0;
+		return histogram;
+	}
+
+	void add(double p) {
+		assertion(is_valid_between_01(p), "p value histogram data not 0-1 or invalid");
+		++_size;
+		if (_size <= _exact_limit) {
+			_values.insert(std::upper_bound(_values.begin(), _values.end(), p), p);
+			return;
+		}
+		if (_bins.empty()) {
+			_bins.resize(_bin_count);
+			for (const auto v : _values) {
+				add_to_bin(v);
+			}
+			_values = {};
+		}
+		add_to_bin(p);
+	}
+
+	template <typename RangeT>
+	void add_all(const RangeT& ps) {
+		for (const auto p : ps) {
+			add(p);
+		}
+	}
+
+	uint64_t size() const {
+		return _size;
+	}
+
+	bool empty() const {
+		return _size == 0;
+	}
+
+	// the values are kept and the statistics are exact
+	bool exact() const {
+		return _size <= _exact_limit;
+	}
+
+	// the values in ascending order while exact()
+	const std::vector<double>& values() const {
+		assertion(exact(), "p value histogram values are binned");
+		return _values;
+	}
+
+	double bin_width() const {
+		return 1. / static_cast<double>(_bin_count);
+	}
+
+	// calls f(bin, rank, from) for every non empty bin in order, rank is the number of values in
+	// lower bins and from the lower end of the bin
+	template <typename FunctorT>
+	void for_each_bin(FunctorT&& f) const {
+		assertion(!exact(), "p value histogram values are not binned");
+		uint64_t rank = 0;
+		for (std::size_t i = 0; i < _bins.size(); ++i) {
+			const auto& b = _bins[i];
+			if (b.count > 0) {
+				f(b, rank, static_cast<double>(i) * bin_width());
+				rank += b.count;
+			}
+		}
+	}
+
+private:
+	void add_to_bin(double p) {
+		const auto index = std::min(static_cast<std::size_t>(p * static_cast<double>(_bins.size())), _bins.size() - 1);
+		auto& b = _bins[index];
+		++b.count;
+		b.min = std::min(b.min, p);
+		b.max = std::max(b.max, p);
+		const auto log_p = log_safe(p);
+		const auto log_complement = log_safe(1. - p);
+		b.sum_log += log_p;
+		b.sum_log_complement += log_complement;
+		b.sum_p += p;
+		b.sum_p_log += p * log_p;
+		b.sum_p_log_complement += p * log_complement;
+	}
+
+	std::size_t _bin_count;
+	std::size_t _exact_limit = default_exact_limit;
+	std::vector<double> _values;
+	std::vector<bin> _bins;
+	uint64_t _size{};
+};
+
+}
@@ -1,28 +1,89 @@
 #pragma once
 
-#include <string>
 #include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
 
 #include "util/assertion.h"
 
 namespace tfr {
+// A named generator of values, copies continue independently from the same state. A generator
+// can also provide operator()(std::span<T>) to produce a whole block at once.
 template <typename T>
 class stream {
 public:
 	using value_type = T;
 
-	stream(std::string name, std::function<value_type()> next)
-		: name(std::move(name)), next(std::move(next)) {
+	template <typename GeneratorT>
+	stream(std::string name, GeneratorT next)
+		: name(std::move(name)), _generator(std::make_unique<generator<GeneratorT>>(std::move(next))) {
+	}
+
+	// a moved from stream copies as moved from
+	stream(const stream& other) : name(other.name), _generator(other._generator ? other._generator->clone() : nullptr) {
 	}
 
+	stream(stream&&) noexcept = default;
+
+	stream& operator=(const stream& other) {
+		if (this != &other) {
+			name = other.name;
+			_generator = other._generator ? other._generator->clone() : nullptr;
+		}
+		return *this;
+	}
+
+	stream& operator=(stream&&) noexcept = default;
+
 	std::string name;
 
 	value_type operator()() {
-		return next();
+		return _generator->next();
+	}
+
+	// the next block.size() values, same as calling the stream for every element
+	void fill(std::span<value_type> block) {
+		_generator->fill(block);
 	}
 
 private:
-	std::function<value_type()> next;
+	struct generator_base {
+		virtual ~generator_base() = default;
+		virtual value_type next() = 0;
+		virtual void fill(std::span<value_type> block) = 0;
+		virtual std::unique_ptr<generator_base> clone() const = 0;
+	};
+
+	template <typename GeneratorT>
+	struct generator final : generator_base {
+		explicit generator(GeneratorT g) : g(std::move(g)) {
+		}
+
+		value_type next() override {
+			return g();
+		}
+
+		void fill(std::span<value_type> block) override {
+			if constexpr (std::is_invocable_v<GeneratorT&, std::span<value_type>>) {
+				g(block);
+			}
+			else {
+				for (auto& v : block) {
+					v = g();
+				}
+			}
+		}
+
+		std::unique_ptr<generator_base> clone() const override {
+			return std::make_unique<generator>(g);
+		}
+
+		GeneratorT g;
+	};
+
+	std::unique_ptr<generator_base> _generator;
 };
 
 template <typename T>
@@ -16,6 +16,13 @@ struct counter_stream {
 		state += increment;
 		return static_cast<T>(state);
 	}
+
+	void operator()(std::span<T> block) {
+		for (auto& v : block) {
+			state += increment;
+			v = static_cast<T>(state);
+		}
+	}
 };
 
 template <typename T>
@@ -92,8 +99,49 @@ stream<T> create_stream_from_data_thread_safe(const std::string& name, const std
 	};
 }
 
+namespace detail {
+template <typename T>
+struct buffered_mixer_stream {
+	stream<T> source;
+	mixer<T> mix;
+	std::vector<T> block;
+	std::size_t index{};
+
+	T operator()() {
+		if (index == block.size()) {
+			source.fill(block);
+			mix(std::span<T>(block));
+			index = 0;
+		}
+		return block[index++];
+	}
+
+	// hands out what is left in the buffer and mixes the rest in place
+	void operator()(std::span<T> values) {
+		const auto buffered = std::min(values.size(), block.size() - index);
+		std::copy_n(block.begin() + static_cast<std::ptrdiff_t>(index), buffered, values.begin());
+		index += buffered;
+		const auto rest = values.subspan(buffered);
+		source.fill(rest);
+		mix(rest);
+	}
+};
+}
+
+// Mixes the source a block at a time with the block kernel of the mixer and hands out the
+// buffered values, the values are the same as mixing them one by one.
+template <typename T>
+stream<T> create_buffered_stream_from_mixer(stream<T> source, const mixer<T>& mixer, std::size_t block_size = 256) {
+	assertion(block_size > 0, "empty mixer block");
+	auto name = mixer.name + "(" + source.name + ")";
+	return {std::move(name), detail::buffered_mixer_stream<T>{std::move(source), mixer, std::vector<T>(block_size), block_size}};
+}
+
 template <typename T>
 stream<T> create_stream_from_mixer(stream<T> source, const mixer<T>& mixer) {
+	if (mixer.mix_block) {
+		return create_buffered_stream_from_mixer(std::move(source), mixer);
+	}
 	return {
 		mixer.name + "(" + source.name + ")",
 		[source, mixer]() mutable { return mixer(source()); }
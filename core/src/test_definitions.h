@@ -22,8 +22,9 @@ struct test_definition {
 	std::string name;
 };
 
+namespace detail {
 template <typename T>
-std::vector<test_definition<T>> get_tests() {
+std::vector<test_definition<T>> create_builtin_tests() {
 	return {
 		{test_type::mean, limit_n_to<T>(mean_test<T>, 1ull << 20), {}, "mean"},
 		{test_type::uniform, uniform_test<T>, {}, "uniform"},
@@ -44,24 +45,115 @@ std::vector<test_definition<T>> get_tests() {
 	};
 }
 
+inline std::size_t to_index(test_type type) {
+	return static_cast<std::size_t>(type);
+}
+
+// test names by test_type, shared by all word sizes
+struct test_name_table {
+	std::vector<std::string> names;
+	std::map<std::string, test_type> types;
+
+	void add(test_type type, const std::string& name) {
+		const auto i = to_index(type);
+		if (i >= names.size()) {
+			names.resize(i + 1);
+		}
+		assertion(names[i].empty() || names[i] == name, "test type is already registered with another name");
+		assertion(!types.contains(name) || types.at(name) == type, "test name is already registered with another type");
+		names[i] = name;
+		types[name] = type;
+	}
+};
+
+inline test_name_table& get_test_name_table() {
+	static test_name_table table = [] {
+		test_name_table t;
+		for (const auto& test_def : create_builtin_tests<uint64_t>()) {
+			t.add(test_def.type, test_def.name);
+		}
+		return t;
+	}();
+	return table;
+}
+
+template <typename T>
+struct test_registry {
+	std::vector<test_definition<T>> tests;
+	// position in tests by test_type, -1 when not registered
+	std::vector<int> positions;
+
+	void add(const test_definition<T>& test_def) {
+		const auto i = to_index(test_def.type);
+		if (i >= positions.size()) {
+			positions.resize(i + 1, -1);
+		}
+		assertion(positions[i] < 0, "test type is already registered");
+		positions[i] = static_cast<int>(tests.size());
+		tests.push_back(test_def);
+	}
+};
+
 template <typename T>
-test_definition<T> get_test_definition(test_type type) {
-	for (const auto& test_def : get_tests<T>()) {
-		if (test_def.type == type) {
-			return test_def;
+test_registry<T>& get_test_registry() {
+	static test_registry<T> registry = [] {
+		test_registry<T> r;
+		for (const auto& test_def : create_builtin_tests<T>()) {
+			r.add(test_def);
 		}
+		return r;
+	}();
+	return registry;
+}
+}
+
+// all registered tests, the builtin ones first
+template <typename T>
+const std::vector<test_definition<T>>& get_tests() {
+	return detail::get_test_registry<T>().tests;
+}
+
+template <typename T>
+const test_definition<T>& get_test_definition(test_type type) {
+	const auto& registry = detail::get_test_registry<T>();
+	const auto i = detail::to_index(type);
+	assertion(i < registry.positions.size() && registry.positions[i] >= 0, "could not find test definition");
+	return registry.tests[registry.positions[i]];
+}
+
+inline const std::string& get_test_name(test_type type) {
+	const auto& names = detail::get_test_name_table().names;
+	const auto i = detail::to_index(type);
+	assertion(i < names.size() && !names[i].empty(), "could not find test name");
+	return names[i];
+}
+
+inline std::optional<test_type> find_test_type(const std::string& name) {
+	const auto& types = detail::get_test_name_table().types;
+	const auto it = types.find(name);
+	if (it == types.end()) {
+		return {};
 	}
-	assertion(false, "could not find test definition");
-	return {};
+	return it->second;
 }
 
-inline std::string get_test_name(test_type type) {
-	return get_test_definition<uint64_t>(type).name;
+// an unused test type for a user test
+inline test_type next_test_type() {
+	return static_cast<test_type>(detail::get_test_name_table().names.size());
+}
+
+// Adds a user test next to the builtin ones for one word size. Only call it at startup,
+// before any test runs or is looked up: the registry is not synchronized and adding a test
+// invalidates the references returned by get_tests and get_test_definition.
+template <typename T>
+void register_test(const test_definition<T>& test_def) {
+	detail::get_test_name_table().add(test_def.type, test_def.name);
+	detail::get_test_registry<T>().add(test_def);
 }
 
 inline std::vector<test_type> default_test_types = []() {
 	std::vector<test_type> types;
-	for (const auto& test_def : get_tests<uint64_t>()) {
+	for (const auto& test_def : detail::create_builtin_tests<uint64_t>()) {
 		types.push_back(test_def.type);
 	}
 	return types;
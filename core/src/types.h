@@ -9,8 +9,11 @@
 
 #include "mixer.h"
 #include "stream.h"
+#include "statistics/p_value_histogram.h"
 #include "util/assertion.h"
 #include "util/math.h"
+#include "util/name_table.h"
+#include "util/perf_counters.h"
 
 namespace tfr {
 template <typename T>
@@ -62,6 +65,14 @@ struct statistic {
 	double df{};
 };
 
+// smaller is worse, two sided statistics fail on both ends
+inline double get_comparable_p_value(const statistic& stat) {
+	if (stat.type == statistic_type::z_score) {
+		return stat.p_value;
+	}
+	return std::min(stat.p_value, 1. - stat.p_value);
+}
+
 
 ///////////////////////////////////////////////////////////////
 /// RESULT TYPES
@@ -80,39 +91,139 @@ inline sub_test_results main_sub_test(std::optional<statistic> s) {
 
 struct test_key {
 	test_type type;
-	std::string sub_test_name;
+	interned_name sub_test_name;
 
 	bool operator <(const test_key& rhs) const {
 		if (type != rhs.type) {
 			return type < rhs.type;
 		}
-		if (sub_test_name != rhs.sub_test_name) {
-			return sub_test_name < rhs.sub_test_name;
+		return sub_test_name < rhs.sub_test_name;
+	}
+
+	// the same order on every run, for output
+	bool less_by_name(const test_key& rhs) const {
+		if (type != rhs.type) {
+			return type < rhs.type;
 		}
-		return false;
+		return sub_test_name.less_by_name(rhs.sub_test_name);
 	}
 };
 
+// names are interned, copying and storing results does not copy strings
 struct test_result {
-	std::string stream_name;
-	std::string mixer_name;
+	interned_name stream_name;
+	interned_name mixer_name;
 	uint64_t n{};
 	test_key key;
 	statistic stats;
 };
 
+// measured run of one job, that is one test over one source
+struct job_timing {
+	test_type type{};
+	std::string stream_name;
+	uint64_t wall_nanoseconds{};
+	uint64_t cpu_nanoseconds{};
+	uint64_t elements{};
+	// estimated from a timed sample of the stream, the remainder is spent in the test itself
+	uint64_t generation_nanoseconds{};
+
+	// hardware counters, only when profiling and supported
+	std::optional<perf_sample> perf;
+
+	uint64_t kernel_nanoseconds() const {
+		return wall_nanoseconds - std::min(generation_nanoseconds, wall_nanoseconds);
+	}
+};
+
+// job timings summed up, e.g. per test or per subject
+struct job_totals {
+	uint64_t jobs{};
+	uint64_t wall_nanoseconds{};
+	uint64_t cpu_nanoseconds{};
+	uint64_t elements{};
+	uint64_t generation_nanoseconds{};
+	uint64_t profiled_jobs{};
+	perf_sample perf;
+
+	void add(const job_timing& t) {
+		++jobs;
+		wall_nanoseconds += t.wall_nanoseconds;
+		cpu_nanoseconds += t.cpu_nanoseconds;
+		elements += t.elements;
+		generation_nanoseconds += t.generation_nanoseconds;
+		if (t.perf) {
+			++profiled_jobs;
+			perf += *t.perf;
+		}
+	}
+};
+
+// running summary of the results of one test key, kept up to date as results are added
+struct test_key_summary {
+	std::size_t worst_index{};
+	double worst_p_value_cmp{};
+	// the p-values in fixed size bins once there are more than the exact limit, fewer are read
+	// from the results, no bins are allocated before
+	p_value_histogram binned_p_values = p_value_histogram::binned(p_value_histogram::default_bin_count);
+	// the uniformity of the p-values, computed on first use after an add and then reused by
+	// every analysis of the pass
+	mutable std::optional<statistic> uniformity;
+};
+
 struct test_battery_result {
 	using test_result_map = std::map<test_key, std::vector<test_result>>;
+	using test_summary_map = std::map<test_key, test_key_summary>;
 
 	std::string test_subject_name;
 	uint64_t n{};
 	uint64_t samples{};
 	int bits{};
 	test_result_map results;
+	test_summary_map summaries;
 	uint64_t passed_milliseconds{};
+	uint64_t predicted_milliseconds{};
+	std::vector<job_timing> job_timings;
+	unsigned int threads{};
 
 	void add(const test_result& r) {
-		results[r.key].push_back(r);
+		auto& rs = results[r.key];
+		auto& summary = summaries[r.key];
+		const auto p_value_cmp = get_comparable_p_value(r.stats);
+		if (rs.empty() || p_value_cmp < summary.worst_p_value_cmp) {
+			summary.worst_index = rs.size();
+			summary.worst_p_value_cmp = p_value_cmp;
+		}
+		summary.uniformity.reset();
+		rs.push_back(r);
+		if (rs.size() == p_value_histogram::default_exact_limit + 1) {
+			for (const auto& e : rs) {
+				summary.binned_p_values.add(e.stats.p_value);
+			}
+		}
+		else if (rs.size() > p_value_histogram::default_exact_limit) {
+			summary.binned_p_values.add(r.stats.p_value);
+		}
+	}
+
+	// the first result with the smallest comparable p-value of the key
+	const test_result& worst(const test_key& key) const {
+		const auto it = summaries.find(key);
+		assertion(it != summaries.end(), "no results for the test key");
+		return results.at(key)[it->second.worst_index];
+	}
+
+	// busy time of the jobs over the thread time available during the pass
+	double thread_utilization() const {
+		if (threads == 0 || job_timings.empty()) {
+			return 0;
+		}
+		uint64_t busy_nanoseconds = 0;
+		for (const auto& t : job_timings) {
+			busy_nanoseconds += t.wall_nanoseconds;
+		}
+		const double available = 1e6 * static_cast<double>(std::max<uint64_t>(passed_milliseconds, 1)) * threads;
+		return std::min(1., static_cast<double>(busy_nanoseconds) / available);
 	}
 
 	const std::vector<test_result>& operator[](const test_key& key) const {
@@ -235,7 +346,8 @@ auto mul(const FunctionT1& a, const FunctionT2& b) {
 }
 
 inline unsigned int default_max_threads() {
-	return std::max(std::thread::hardware_concurrency() - 4, 2u);
+	// keep a few cores free, hardware_concurrency is unsigned and may be less than 4 (or 0 if unknown)
+	return std::max(std::thread::hardware_concurrency(), 6u) - 4;
 }
 
 class binary_square_matrix {
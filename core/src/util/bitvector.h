@@ -1,6 +1,9 @@
 #pragma once
 
-#include <cmath>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -8,68 +11,134 @@
 
 namespace tfr {
 
+// Bits in 64 bit words, up to inline_bits are stored in the object itself so copies of search
+// states do not allocate. Bits past size() are always zero.
 struct bit_vector {
+	static constexpr int inline_bits = 256;
+
 	bit_vector() = default;
 
-	bit_vector(int bits) : bits(bits) {
-		data.resize(std::ceil(bits / 8.));
+	bit_vector(int bits) {
+		resize(bits);
 	}
 
 	bool get_bit(int bit) const {
-		assertion(bit < bits, "bit oob");
-		const size_t index = bit / 8;
-		const int shift = bit - 8 * index;
-		return ((data[index] >> shift) & 1) == 1;
+		assertion(bit >= 0 && bit < bits, "bit oob");
+		return ((words()[bit / word_bits] >> (bit % word_bits)) & 1) == 1;
 	}
 
 	void set_bit(size_t bit, bool value) {
-		assertion(bit < bits, "bit oob");
-		const size_t index = bit / 8;
-		assertion(index < data.size(), "bit data oob");
-
-		const auto shift = bit - 8 * index;
-		if (value)
-			data[index] |= (value << shift);
-		else
-			data[index] &= ~(1 << shift);
+		assertion(bit < static_cast<size_t>(bits), "bit oob");
+		auto& word = words()[bit / word_bits];
+		const uint64_t mask = uint64_t{1} << (bit % word_bits);
+		word = value ? word | mask : word & ~mask;
 	}
 
 	int size() const { return bits; }
 
+	bool operator==(const bit_vector& rhs) const {
+		return (*this <=> rhs) == 0;
+	}
+
+	std::strong_ordering operator<=>(const bit_vector& rhs) const {
+		if (const auto c = bits <=> rhs.bits; c != 0) {
+			return c;
+		}
+		const auto* a = words();
+		const auto* b = rhs.words();
+		for (int i = 0; i < word_count(bits); ++i) {
+			if (const auto c = a[i] <=> b[i]; c != 0) {
+				return c;
+			}
+		}
+		return std::strong_ordering::equal;
+	}
+
 	int count() const {
 		int sum = 0;
-		for (int i = 0; i < bits; ++i) {
-			if (get_bit(i)) sum++;
+		const auto* w = words();
+		for (int i = 0; i < word_count(bits); ++i) {
+			sum += std::popcount(w[i]);
 		}
 		return sum;
 	}
 
+	// the count bits from from_bit on, the first one is the lowest bit of the value
 	template <typename T = uint64_t>
 	T get(int from_bit, int count) const {
-		T v = 0;
-		int s = 0;
-		const int to_bit = from_bit + count;
-		for (int i = from_bit; i < to_bit; ++i, ++s) {
-			if (get_bit(i)) {
-				v |= static_cast<T>(1) << s;
-			}
+		assertion(count >= 0 && count <= word_bits && from_bit >= 0 && from_bit + count <= bits, "bit field oob");
+		if (count == 0) {
+			return 0;
+		}
+		const auto* w = words();
+		const int index = from_bit / word_bits;
+		const int shift = from_bit % word_bits;
+		uint64_t v = w[index] >> shift;
+		if (shift + count > word_bits) {
+			v |= w[index + 1] << (word_bits - shift);
 		}
-		return v;
+		return static_cast<T>(v & low_mask(count));
 	}
 
-	void add(uint64_t v, int count) {
-		const int old_bits = bits;
-		bits += count;
-		data.resize(static_cast<std::size_t>(std::ceil(bits / 8.)));
-		for (int i = 0; i < count; ++i) {
-			set_bit(old_bits + i, ((v >> i) & 1) == 1);
+	// inverse of get, bits of v above count are ignored
+	void set(int from_bit, int count, uint64_t v) {
+		assertion(count >= 0 && count <= word_bits && from_bit >= 0 && from_bit + count <= bits, "bit field oob");
+		if (count == 0) {
+			return;
+		}
+		auto* w = words();
+		const int index = from_bit / word_bits;
+		const int shift = from_bit % word_bits;
+		const uint64_t mask = low_mask(count);
+		v &= mask;
+		w[index] = (w[index] & ~(mask << shift)) | (v << shift);
+		if (shift + count > word_bits) {
+			const int spill = word_bits - shift;
+			w[index + 1] = (w[index + 1] & ~(mask >> spill)) | (v >> spill);
 		}
 	}
 
+	void add(uint64_t v, int count) {
+		const int old_bits = bits;
+		resize(bits + count);
+		set(old_bits, count, v);
+	}
 
 private:
+	static constexpr int word_bits = 64;
+
+	static constexpr int word_count(int bits) {
+		return (bits + word_bits - 1) / word_bits;
+	}
+
+	static constexpr uint64_t low_mask(int count) {
+		return count == word_bits ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+	}
+
+	const uint64_t* words() const {
+		return bits <= inline_bits ? _inline.data() : _heap.data();
+	}
+
+	uint64_t* words() {
+		return bits <= inline_bits ? _inline.data() : _heap.data();
+	}
+
+	// only grows, the new bits are zero
+	void resize(int new_bits) {
+		assertion(new_bits >= bits, "bit_vector only grows");
+		if (new_bits > inline_bits) {
+			if (bits <= inline_bits) {
+				_heap.assign(_inline.begin(), _inline.end());
+				_inline = {};
+			}
+			_heap.resize(static_cast<std::size_t>(word_count(new_bits)));
+		}
+		bits = new_bits;
+	}
+
 	int bits = 0;
-	std::vector<unsigned char> data;
+	std::array<uint64_t, inline_bits / word_bits> _inline{};
+	std::vector<uint64_t> _heap;
 };
 
 inline std::string to_string(const bit_vector& bv) {
@@ -80,4 +149,14 @@ inline std::string to_string(const bit_vector& bv) {
 	return s;
 }
 
+// inverse of to_string
+inline bit_vector to_bit_vector(const std::string& s) {
+	bit_vector bv(static_cast<int>(s.size()));
+	for (std::size_t i = 0; i < s.size(); ++i) {
+		assertion(s[i] == '0' || s[i] == '1', "invalid bit string");
+		bv.set_bit(i, s[i] == '1');
+	}
+	return bv;
+}
+
 }
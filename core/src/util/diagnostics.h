@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "statistics/avalanche.h"
+#include "streams.h"
+#include "types.h"
+#include "util/jobs.h"
+
+namespace tfr {
+namespace diagnostics {
+// the lag-1 scatter plot bins consecutive values by their top bits
+constexpr int lag_bits = 8;
+constexpr int lag_size = 1 << lag_bits;
+
+template <typename T>
+std::size_t to_lag_bin(T v) {
+	return static_cast<std::size_t>(v >> (bit_sizeof<T>() - lag_bits));
+}
+
+// counts every pair of consecutive values into lag, lag_size * lag_size bins with the first
+// value as the row
+template <typename T>
+void add_lag_pairs(std::span<const T> values, std::vector<uint64_t>& lag) {
+	for (std::size_t i = 1; i < values.size(); ++i) {
+		++lag[to_lag_bin(values[i - 1]) * lag_size + to_lag_bin(values[i])];
+	}
+}
+
+// mid grey at the expected density, one step of 32 per doubling, black for empty bins
+inline unsigned char to_density_grey(uint64_t count, double expected) {
+	if (count == 0) {
+		return 0;
+	}
+	return static_cast<unsigned char>(std::clamp(128 + 32 * std::log2(static_cast<double>(count) / expected), 0., 255.));
+}
+
+// grey for an unbiased bit, red for too many flips and blue for too few, saturated at 8 sigma
+inline std::array<unsigned char, 3> to_bias_color(double z) {
+	const double t = std::min(std::abs(z) / 8, 1.);
+	const auto strong = static_cast<unsigned char>(128 + 127 * t);
+	const auto weak = static_cast<unsigned char>(128 - 128 * t);
+	if (z > 0) {
+		return {strong, weak, weak};
+	}
+	return {weak, weak, strong};
+}
+
+// avalanche_generate_bic over consecutive ranges of the counter on all threads, the same
+// counts as one call over the whole range
+template <typename T>
+std::vector<uint64_t> generate_bic_parallel(const mixer<T>& mixer, uint64_t n, unsigned int threads = default_max_threads()) {
+	constexpr auto bits = bit_sizeof<T>();
+	threads = std::max(threads, 1u);
+	jobs<std::vector<uint64_t>> js;
+	for (unsigned int i = 0; i < threads; ++i) {
+		const uint64_t from = n * i / threads;
+		const uint64_t to = n * (i + 1) / threads;
+		js.push_back([&mixer, from, to] {
+			return avalanche_generate_bic<T>(to - from, create_counter_stream<T>(1, from), mixer);
+		});
+	}
+	std::vector<uint64_t> counts(bits * bits);
+	std::mutex mutex;
+	run_jobs<std::vector<uint64_t>>(js, [&counts, &mutex](const std::vector<uint64_t>& c) {
+		std::lock_guard lg(mutex);
+		for (std::size_t i = 0; i < counts.size(); ++i) {
+			counts[i] += c[i];
+		}
+	}, threads);
+	return counts;
+}
+
+// the lag-1 bins of mix(i), mix(i + 1) for i below n, on all threads. Every job counts its
+// range of the counter in chunks into a histogram of its own, one more value per chunk pairs
+// with the next chunk, and the histograms are added up once per job.
+template <typename T>
+std::vector<uint64_t> generate_lag_parallel(const mixer<T>& mixer, uint64_t n, unsigned int threads = default_max_threads()) {
+	static constexpr uint64_t chunk = 1 << 16;
+	threads = std::max(threads, 1u);
+	jobs<std::vector<uint64_t>> js;
+	for (unsigned int i = 0; i < threads; ++i) {
+		const uint64_t from = n * i / threads;
+		const uint64_t to = n * (i + 1) / threads;
+		js.push_back([&mixer, from, to] {
+			std::vector<uint64_t> lag(lag_size * lag_size);
+			std::vector<T> values;
+			for (uint64_t first = from; first < to; first += chunk) {
+				values.resize(std::min(chunk, to - first) + 1);
+				for (std::size_t x = 0; x < values.size(); ++x) {
+					values[x] = static_cast<T>(first + x);
+				}
+				mixer(std::span<T>(values));
+				add_lag_pairs<T>(values, lag);
+			}
+			return lag;
+		});
+	}
+	std::vector<uint64_t> lag(lag_size * lag_size);
+	std::mutex mutex;
+	run_jobs<std::vector<uint64_t>>(js, [&lag, &mutex](const std::vector<uint64_t>& l) {
+		std::lock_guard lg(mutex);
+		for (std::size_t i = 0; i < lag.size(); ++i) {
+			lag[i] += l[i];
+		}
+	}, threads);
+	return lag;
+}
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace tfr {
+
+class hasher {
+public:
+	// FNV-1a, stable across runs and platforms
+	hasher& add_bytes(const void* data, std::size_t size) {
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < size; ++i) {
+			_hash ^= bytes[i];
+			_hash *= 0x100000001b3ull;
+		}
+		return *this;
+	}
+
+	template <typename T>
+	hasher& add(const T& v) {
+		static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+		return add_bytes(&v, sizeof(T));
+	}
+
+	hasher& add(const std::string& s) {
+		add(static_cast<uint64_t>(s.size()));
+		return add_bytes(s.data(), s.size());
+	}
+
+	uint64_t get() const {
+		return _hash;
+	}
+
+private:
+	uint64_t _hash = 0xcbf29ce484222325ull;
+};
+
+inline std::string to_hex(uint64_t v) {
+	std::ostringstream oss;
+	oss << std::hex << std::setw(16) << std::setfill('0') << v;
+	return oss.str();
+}
+
+}
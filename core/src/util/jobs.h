@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <functional>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
+#include "assertion.h"
 
 namespace tfr {
 
@@ -13,6 +20,8 @@ using job = std::function<T()>;
 template <typename T>
 using jobs = std::vector<job<T>>;
 
+// the first exception of a job or the collector stops taking jobs and is rethrown once all
+// threads are joined
 template <typename T>
 void run_jobs(jobs<T> jobs,
               const std::function<void(const T&)>& result_collector,
@@ -20,10 +29,11 @@ void run_jobs(jobs<T> jobs,
 	if (jobs.empty()) {
 		return;
 	}
-	const auto job_queue = [&jobs]()-> std::optional<job<T>> {
-		static std::mutex m;
+	std::mutex m;
+	std::exception_ptr error;
+	const auto job_queue = [&jobs, &m, &error]()-> std::optional<job<T>> {
 		std::lock_guard lg(m);
-		if (jobs.empty()) {
+		if (jobs.empty() || error) {
 			return {};
 		}
 		auto j = jobs.back();
@@ -34,9 +44,17 @@ void run_jobs(jobs<T> jobs,
 	num_threads = std::min(num_threads, static_cast<unsigned int>(jobs.size()));
 	std::vector<std::thread> threads;
 	for (unsigned int i = 0; i < num_threads; ++i) {
-		threads.emplace_back([&job_queue, &result_collector]() {
-			while (const auto& job = job_queue()) {
-				result_collector((*job)());
+		threads.emplace_back([&job_queue, &result_collector, &m, &error]() {
+			try {
+				while (const auto& job = job_queue()) {
+					result_collector((*job)());
+				}
+			}
+			catch (...) {
+				std::lock_guard lg(m);
+				if (!error) {
+					error = std::current_exception();
+				}
 			}
 		});
 	}
@@ -44,6 +62,98 @@ void run_jobs(jobs<T> jobs,
 	for (auto& t : threads) {
 		t.join();
 	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
 }
 
+// A fixed set of worker threads shared by any number of concurrent callers of run(). The
+// jobs of all callers go into one queue ordered by their predicted cost, the most expensive
+// first whichever caller queued it, and in order of queueing for equal costs; with several
+// callers the workers stay busy while one of them is down to its last few jobs.
+class job_pool {
+public:
+	explicit job_pool(unsigned int num_threads) {
+		for (unsigned int i = 0; i < std::max(num_threads, 1u); ++i) {
+			_threads.emplace_back([this]() { work(); });
+		}
+	}
+
+	job_pool(const job_pool&) = delete;
+	job_pool& operator=(const job_pool&) = delete;
+
+	~job_pool() {
+		{
+			std::lock_guard lg(_mutex);
+			_stop = true;
+		}
+		_cv.notify_all();
+		for (auto& t : _threads) {
+			t.join();
+		}
+	}
+
+	// blocks until all jobs are done, without costs in the same job order as run_jobs (from the
+	// back), costs has none or one entry per job
+	template <typename T>
+	void run(jobs<T> jobs, const std::function<void(const T&)>& result_collector, const std::vector<double>& costs = {}) {
+		if (jobs.empty()) {
+			return;
+		}
+		assertion(costs.empty() || costs.size() == jobs.size(), "job costs do not match the jobs");
+		std::mutex done_mutex;
+		std::condition_variable done_cv;
+		std::size_t remaining = jobs.size();
+		{
+			std::lock_guard lg(_mutex);
+			for (std::size_t i = jobs.size(); i-- > 0;) {
+				_queue.emplace(costs.empty() ? 0. : costs[i], [job = std::move(jobs[i]), &result_collector, &done_mutex, &done_cv, &remaining]() {
+					result_collector(job());
+					std::lock_guard done_lg(done_mutex);
+					if (--remaining == 0) {
+						done_cv.notify_all();
+					}
+				});
+			}
+		}
+		_cv.notify_all();
+		std::unique_lock ul(done_mutex);
+		done_cv.wait(ul, [&remaining]() { return remaining == 0; });
+	}
+
+	unsigned int size() const {
+		return static_cast<unsigned int>(_threads.size());
+	}
+
+	// jobs not started yet
+	std::size_t queued() {
+		std::lock_guard lg(_mutex);
+		return _queue.size();
+	}
+
+private:
+	void work() {
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock ul(_mutex);
+				_cv.wait(ul, [this]() { return _stop || !_queue.empty(); });
+				if (_queue.empty()) {
+					return;
+				}
+				job = std::move(_queue.begin()->second);
+				_queue.erase(_queue.begin());
+			}
+			job();
+		}
+	}
+
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	// equal costs are inserted after each other
+	std::multimap<double, std::function<void()>, std::greater<>> _queue;
+	bool _stop = false;
+	std::vector<std::thread> _threads;
+};
+
 }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace tfr {
+
+inline std::string json_escape(const std::string& text) {
+	std::string r;
+	r.reserve(text.size());
+	for (const char c : text) {
+		switch (c) {
+		case '"': r += "\\\"";
+			break;
+		case '\\': r += "\\\\";
+			break;
+		case '\n': r += "\\n";
+			break;
+		case '\r': r += "\\r";
+			break;
+		case '\t': r += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				std::ostringstream oss;
+				oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+				r += oss.str();
+			}
+			else {
+				r += c;
+			}
+		}
+	}
+	return r;
+}
+
+// builds a single line json object, e.g. {"a":1,"b":"x"}
+class json_object {
+public:
+	json_object& add(const std::string& key, const std::string& value) {
+		return raw(key, "\"" + json_escape(value) + "\"");
+	}
+
+	json_object& add(const std::string& key, const char* value) {
+		return add(key, std::string(value));
+	}
+
+	json_object& add(const std::string& key, int value) {
+		return raw(key, std::to_string(value));
+	}
+
+	json_object& add(const std::string& key, int64_t value) {
+		return raw(key, std::to_string(value));
+	}
+
+	json_object& add(const std::string& key, uint64_t value) {
+		return raw(key, std::to_string(value));
+	}
+
+	// json has no nan or infinity, they are written as null
+	json_object& add(const std::string& key, double value) {
+		if (!std::isfinite(value)) {
+			return raw(key, "null");
+		}
+		std::ostringstream oss;
+		oss << std::setprecision(17) << value;
+		return raw(key, oss.str());
+	}
+
+	json_object& add(const std::string& key, const json_object& value) {
+		return raw(key, value.to_string());
+	}
+
+	json_object& add_bool(const std::string& key, bool value) {
+		return raw(key, value ? "true" : "false");
+	}
+
+	json_object& raw(const std::string& key, const std::string& value) {
+		if (!_body.empty()) {
+			_body += ",";
+		}
+		_body += "\"" + json_escape(key) + "\":" + value;
+		return *this;
+	}
+
+	std::string to_string() const {
+		return "{" + _body + "}";
+	}
+
+private:
+	std::string _body;
+};
+
+}
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cstdint>
 #include <limits>
+#include <vector>
 
 #include "assertion.h"
 
@@ -63,14 +64,20 @@ inline double snap_to_01(double x) {
 	return x;
 }
 
-inline uint64_t stirling_second_kind(int n, int k) {
-	if (n == 0 && k == 0) {
-		return 1;
-	}
-	if (n == 0 || k == 0) {
+// S(n, k) = k * S(n - 1, k) + S(n - 1, k - 1) one row at a time, wraps around like uint64_t on overflow
+constexpr uint64_t stirling_second_kind(int n, int k) {
+	if (n < 0 || k < 0 || k > n) {
 		return 0;
 	}
-	return k * stirling_second_kind(n - 1, k) + stirling_second_kind(n - 1, k - 1);
+	std::vector<uint64_t> row(k + 1);
+	row[0] = 1;
+	for (int i = 1; i <= n; ++i) {
+		for (int j = std::min(i, k); j >= 1; --j) {
+			row[j] = j * row[j] + row[j - 1];
+		}
+		row[0] = 0;
+	}
+	return row[k];
 }
 
 inline double harmonic_asymptotic(double n) {
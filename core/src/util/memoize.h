@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+
+namespace tfr {
+
+// Thread safe table of values computed once per key, entries are never removed so the
+// returned references stay valid. Concurrent misses of the same key may compute it twice
+// but only the first value is kept.
+template <typename KeyT, typename ValueT>
+class memoized {
+public:
+	explicit memoized(std::function<ValueT(const KeyT&)> compute) : _compute(std::move(compute)) {
+	}
+
+	const ValueT& operator()(const KeyT& key) const {
+		{
+			std::shared_lock lock(_mutex);
+			const auto it = _values.find(key);
+			if (it != _values.end()) {
+				return it->second;
+			}
+		}
+		auto value = _compute(key);
+		std::unique_lock lock(_mutex);
+		return _values.try_emplace(key, std::move(value)).first->second;
+	}
+
+	std::size_t size() const {
+		std::shared_lock lock(_mutex);
+		return _values.size();
+	}
+
+private:
+	std::function<ValueT(const KeyT&)> _compute;
+	mutable std::shared_mutex _mutex;
+	mutable std::map<KeyT, ValueT> _values;
+};
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "assertion.h"
+
+namespace tfr {
+
+using name_id = uint32_t;
+
+// Thread safe string interning. Ids are dense, start with the empty string at 0 and are never
+// removed, so the returned names stay valid for the lifetime of the table.
+class name_table {
+public:
+	name_table() {
+		intern({});
+	}
+
+	name_table(const name_table&) = delete;
+	name_table& operator=(const name_table&) = delete;
+
+	name_id intern(std::string_view name) {
+		{
+			std::shared_lock lock(_mutex);
+			const auto it = _ids.find(name);
+			if (it != _ids.end()) {
+				return it->second;
+			}
+		}
+		std::unique_lock lock(_mutex);
+		const auto it = _ids.find(name);
+		if (it != _ids.end()) {
+			return it->second;
+		}
+		const auto id = static_cast<name_id>(_names.size());
+		// the view points into the deque, its elements never move
+		const auto& stored = _names.emplace_back(name);
+		_ids.emplace(stored, id);
+		return id;
+	}
+
+	const std::string& name(name_id id) const {
+		std::shared_lock lock(_mutex);
+		assertion(id < _names.size(), "unknown name id");
+		return _names[id];
+	}
+
+	std::size_t size() const {
+		std::shared_lock lock(_mutex);
+		return _names.size();
+	}
+
+private:
+	mutable std::shared_mutex _mutex;
+	std::unordered_map<std::string_view, name_id> _ids;
+	std::deque<std::string> _names;
+};
+
+inline name_table& get_name_table() {
+	static name_table table;
+	return table;
+}
+
+// A string stored as its id in the global name table, copies, compares and orders like an
+// integer. The order is the order the names were interned in, which depends on thread timing;
+// output that has to be the same on every run sorts with less_by_name.
+class interned_name {
+public:
+	interned_name() = default;
+
+	interned_name(std::string_view name) : _id(get_name_table().intern(name)) {
+	}
+
+	interned_name(const std::string& name) : interned_name(std::string_view(name)) {
+	}
+
+	interned_name(const char* name) : interned_name(std::string_view(name)) {
+	}
+
+	name_id id() const {
+		return _id;
+	}
+
+	const std::string& str() const {
+		return get_name_table().name(_id);
+	}
+
+	bool empty() const {
+		return _id == 0;
+	}
+
+	bool operator==(const interned_name& rhs) const {
+		return _id == rhs._id;
+	}
+
+	bool operator!=(const interned_name& rhs) const {
+		return _id != rhs._id;
+	}
+
+	bool operator<(const interned_name& rhs) const {
+		return _id < rhs._id;
+	}
+
+	// the order of the strings, locks the name table
+	bool less_by_name(const interned_name& rhs) const {
+		return _id != rhs._id && str() < rhs.str();
+	}
+
+private:
+	name_id _id{};
+};
+
+inline std::ostream& operator<<(std::ostream& os, const interned_name& name) {
+	return os << name.str();
+}
+
+}
+
+template <>
+struct std::hash<tfr::interned_name> {
+	std::size_t operator()(const tfr::interned_name& name) const noexcept {
+		return std::hash<tfr::name_id>()(name.id());
+	}
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tfr {
+
+struct perf_sample {
+	uint64_t cycles{};
+	uint64_t instructions{};
+	uint64_t cache_misses{};
+	uint64_t branch_misses{};
+
+	perf_sample& operator+=(const perf_sample& o) {
+		cycles += o.cycles;
+		instructions += o.instructions;
+		cache_misses += o.cache_misses;
+		branch_misses += o.branch_misses;
+		return *this;
+	}
+
+	double instructions_per_cycle() const {
+		return cycles > 0 ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.;
+	}
+};
+
+// Hardware counters of the calling thread through perf_event_open. Only available on
+// linux and only when the kernel allows it (see /proc/sys/kernel/perf_event_paranoid),
+// otherwise available() is false and stop() returns nothing.
+class perf_counters {
+public:
+	perf_counters() {
+#ifdef __linux__
+		constexpr std::array<uint64_t, counter_count> configs{
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+		for (std::size_t i = 0; i < counter_count; ++i) {
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[i];
+			attr.disabled = i == 0 ? 1 : 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : _fds[0], 0));
+			if (_fds[i] < 0) {
+				close_all();
+				return;
+			}
+		}
+#endif
+	}
+
+	~perf_counters() {
+		close_all();
+	}
+
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator=(const perf_counters&) = delete;
+
+	bool available() const {
+		return _fds[0] >= 0;
+	}
+
+	void start() {
+#ifdef __linux__
+		if (available()) {
+			ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+#endif
+	}
+
+	std::optional<perf_sample> stop() {
+#ifdef __linux__
+		if (available()) {
+			ioctl(_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			struct {
+				uint64_t nr;
+				std::array<uint64_t, counter_count> values;
+			} data{};
+			if (read(_fds[0], &data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data.nr == counter_count) {
+				return perf_sample{data.values[0], data.values[1], data.values[2], data.values[3]};
+			}
+		}
+#endif
+		return {};
+	}
+
+	// checks once whether counters can be opened in this process
+	static bool is_supported() {
+		static const bool supported = perf_counters().available();
+		return supported;
+	}
+
+private:
+	static constexpr std::size_t counter_count = 4;
+
+	void close_all() {
+#ifdef __linux__
+		for (auto& fd : _fds) {
+			if (fd >= 0) {
+				close(fd);
+			}
+			fd = -1;
+		}
+#endif
+	}
+
+	std::array<int, counter_count> _fds{-1, -1, -1, -1};
+};
+
+}
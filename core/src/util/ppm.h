@@ -1,50 +1,422 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <fstream>
-#include <iostream>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "assertion.h"
+#include "stream.h"
+
 namespace tfr {
 
-inline bool write_ppm(const std::string& path, const std::vector<char>& data, int width, int height, int max) {
-	std::ofstream outfile(path, std::ofstream::binary);
-	if (outfile.fail()) {
-		std::cout << "Failed to open " << path << std::endl;
-		return false;
+// netpbm is P5 for 1 channel (grey) and P6 for 3 channels (rgb)
+enum class image_format { netpbm, png };
+
+inline image_format get_image_format(const std::string& path) {
+	const std::string png = ".png";
+	return path.size() >= png.size() && path.compare(path.size() - png.size(), png.size(), png) == 0 ? image_format::png : image_format::netpbm;
+}
+
+inline uint32_t crc32(std::span<const unsigned char> data, uint32_t crc = 0) {
+	static const auto table = [] {
+		std::array<uint32_t, 256> t{};
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+	crc = ~crc;
+	for (const auto b : data) {
+		crc = table[(crc ^ b) & 0xff] ^ (crc >> 8);
 	}
+	return ~crc;
+}
 
-	outfile << "P6" << "\n" << width << " " << height << "\n" << max << "\n";
-	outfile.write(data.data(), data.size());
-	outfile.close();
-	return !outfile.fail();
+inline uint32_t adler32(std::span<const unsigned char> data, uint32_t adler = 1) {
+	// largest run of bytes before the sums have to be reduced
+	constexpr std::size_t run = 5552;
+	uint32_t a = adler & 0xffff;
+	uint32_t b = adler >> 16;
+	for (std::size_t i = 0; i < data.size(); i += run) {
+		const auto end = std::min(data.size(), i + run);
+		for (std::size_t j = i; j < end; ++j) {
+			a += data[j];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
 }
 
-template <typename T>
-void write_ppm(const std::string& filename, const int width, const int height, const std::function<T(T x, T y)>& func) {
-	std::vector<char> data;
-	for (T y = 0; y < height; ++y) {
-		for (T x = 0; x < width; ++x) {
-			T p = func(x, y);
-			for (auto byte = 0; byte < sizeof(T); ++byte) {
-				const unsigned char grey = (p >> (8 * byte)) & 0xff;
-				data.push_back(grey);
-				data.push_back(grey);
-				data.push_back(grey);
+namespace detail {
+// the fixed Huffman code of a deflate literal/length symbol, bits are sent starting with the
+// most significant one
+struct fixed_code {
+	uint32_t code;
+	int bits;
+};
+
+inline fixed_code get_fixed_code(int symbol) {
+	if (symbol < 144) {
+		return {static_cast<uint32_t>(0x30 + symbol), 8};
+	}
+	if (symbol < 256) {
+		return {static_cast<uint32_t>(0x190 + symbol - 144), 9};
+	}
+	if (symbol < 280) {
+		return {static_cast<uint32_t>(symbol - 256), 7};
+	}
+	return {static_cast<uint32_t>(0xc0 + symbol - 280), 8};
+}
+
+// deflate length symbols from 257 on: the shortest length of each and its extra bits
+constexpr std::array<int, 29> length_base = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<int, 29> length_extra_bits = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr int min_match = 3;
+constexpr int max_match = 258;
+
+// index into length_base of a match length
+inline int get_length_index(int length) {
+	return static_cast<int>(std::upper_bound(length_base.begin(), length_base.end(), length) - length_base.begin()) - 1;
+}
+
+// Splits data into literals and runs repeating the previous byte, the only matches used, at
+// distance 1. Calls f(byte, 0) for a literal and f(byte, length) for a run.
+template <typename FunctorT>
+void for_each_run_token(std::span<const unsigned char> data, FunctorT&& f) {
+	for (std::size_t i = 0; i < data.size();) {
+		std::size_t length = 0;
+		if (i > 0) {
+			const auto limit = std::min(data.size() - i, static_cast<std::size_t>(max_match));
+			while (length < limit && data[i + length] == data[i - 1]) {
+				++length;
 			}
 		}
+		if (length >= min_match) {
+			f(data[i], static_cast<int>(length));
+			i += length;
+		} else {
+			f(data[i], 0);
+			++i;
+		}
 	}
-	write_ppm(filename, data, width, height, 255);
+}
 }
 
-template <typename T>
-void write_ppm(const std::string& filename, stream<T> source) {
-	constexpr int size = 512;
-	write_ppm<T>(
-		filename,
-		size, size,
-		[source](T, T) mutable { return source(); });
+// Writes an image a band of rows at a time straight to the file, nothing but one band is held
+// in memory. PNG bands are deflated without a compression library: runs of the same byte are
+// coded as matches at distance 1 with the fixed Huffman codes, or the band is stored as it is
+// when that is smaller, e.g. for noise. Every band is one IDAT chunk.
+class image_writer {
+public:
+	image_writer(const std::string& path, int width, int height, int channels)
+		: _file(path, std::ofstream::binary), _format(get_image_format(path)), _width(width), _height(height), _channels(channels) {
+		assertion(channels == 1 || channels == 3, "images have 1 or 3 channels");
+		if (_file.fail()) {
+			throw std::runtime_error("could not open " + path);
+		}
+		if (_format == image_format::netpbm) {
+			_file << (channels == 1 ? "P5" : "P6") << "\n" << width << " " << height << "\n255\n";
+			return;
+		}
+		const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+		_file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+		_chunk.clear();
+		put_u32(static_cast<uint32_t>(width));
+		put_u32(static_cast<uint32_t>(height));
+		// 8 bit depth, grey or rgb, deflate, no filter, no interlace
+		_chunk.insert(_chunk.end(), {8, static_cast<unsigned char>(channels == 1 ? 0 : 2), 0, 0, 0});
+		write_chunk("IHDR");
+	}
 
+	~image_writer() {
+		close();
+	}
+
+	image_writer(const image_writer&) = delete;
+	image_writer& operator=(const image_writer&) = delete;
 
+	std::size_t row_size() const {
+		return static_cast<std::size_t>(_width) * _channels;
+	}
+
+	// whole rows, top to bottom
+	void write_rows(std::span<const unsigned char> rows) {
+		assertion(rows.size() % row_size() == 0, "image rows are not complete");
+		const auto count = static_cast<int>(rows.size() / row_size());
+		assertion(_rows + count <= _height, "more image rows than the height");
+		_rows += count;
+		if (_format == image_format::netpbm) {
+			_file.write(reinterpret_cast<const char*>(rows.data()), static_cast<std::streamsize>(rows.size()));
+			return;
+		}
+		_chunk.clear();
+		start_zlib();
+		// every row starts with its filter type, 0 is none
+		_band.clear();
+		for (int y = 0; y < count; ++y) {
+			const auto row = rows.subspan(y * row_size(), row_size());
+			_band.push_back(0);
+			_band.insert(_band.end(), row.begin(), row.end());
+		}
+		_adler = adler32(_band, _adler);
+		if (get_fixed_bits(_band) < get_stored_bits(_band.size())) {
+			put_fixed(_band);
+		} else {
+			put_stored(_band);
+		}
+		write_chunk("IDAT");
+	}
+
+	// true if every row was written and nothing failed
+	bool close() {
+		if (!_file.is_open()) {
+			return _ok;
+		}
+		if (_format == image_format::png) {
+			_chunk.clear();
+			start_zlib();
+			// empty final fixed block, then the checksum of the uncompressed data
+			put_bits(0b011, 3);
+			put_symbol(end_of_block);
+			align_bits();
+			put_u32(_adler);
+			write_chunk("IDAT");
+			_chunk.clear();
+			write_chunk("IEND");
+		}
+		_file.close();
+		_ok = !_file.fail() && _rows == _height;
+		return _ok;
+	}
+
+private:
+	// largest stored deflate block
+	static constexpr std::size_t max_stored = 65535;
+	static constexpr int end_of_block = 256;
+
+	void put_u32(uint32_t v) {
+		_chunk.insert(_chunk.end(), {static_cast<unsigned char>(v >> 24), static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 8), static_cast<unsigned char>(v)});
+	}
+
+	void start_zlib() {
+		if (!_started) {
+			// zlib header: deflate with a 32K window, no dictionary
+			_chunk.insert(_chunk.end(), {0x78, 0x01});
+			_started = true;
+		}
+	}
+
+	// deflate packs values starting with the least significant bit, the bits of a byte not
+	// complete at the end of a band go to the next chunk
+	void put_bits(uint32_t value, int count) {
+		_bits |= static_cast<uint64_t>(value) << _bit_count;
+		_bit_count += count;
+		while (_bit_count >= 8) {
+			_chunk.push_back(static_cast<unsigned char>(_bits));
+			_bits >>= 8;
+			_bit_count -= 8;
+		}
+	}
+
+	void align_bits() {
+		if (_bit_count > 0) {
+			put_bits(0, 8 - _bit_count);
+		}
+	}
+
+	// Huffman codes are the other way round
+	void put_code(uint32_t code, int count) {
+		uint32_t reversed = 0;
+		for (int i = 0; i < count; ++i) {
+			reversed |= ((code >> i) & 1) << (count - 1 - i);
+		}
+		put_bits(reversed, count);
+	}
+
+	void put_symbol(int symbol) {
+		const auto c = detail::get_fixed_code(symbol);
+		put_code(c.code, c.bits);
+	}
+
+	static uint64_t get_stored_bits(std::size_t size) {
+		// at worst 7 bits to align each block header
+		return 8 * (size + 5 * ((size + max_stored - 1) / max_stored)) + 7;
+	}
+
+	static uint64_t get_fixed_bits(std::span<const unsigned char> data) {
+		uint64_t bits = 3 + 7;
+		detail::for_each_run_token(data, [&bits](unsigned char byte, int length) {
+			if (length == 0) {
+				bits += detail::get_fixed_code(byte).bits;
+				return;
+			}
+			const auto index = detail::get_length_index(length);
+			// and 5 bits of the distance
+			bits += detail::get_fixed_code(257 + index).bits + detail::length_extra_bits[index] + 5;
+		});
+		return bits;
+	}
+
+	// not final, stored blocks
+	void put_stored(std::span<const unsigned char> data) {
+		while (!data.empty()) {
+			const auto length = static_cast<uint16_t>(std::min(data.size(), max_stored));
+			put_bits(0b000, 3);
+			align_bits();
+			_chunk.insert(_chunk.end(), {static_cast<unsigned char>(length), static_cast<unsigned char>(length >> 8), static_cast<unsigned char>(~length), static_cast<unsigned char>(~length >> 8)});
+			_chunk.insert(_chunk.end(), data.begin(), data.begin() + length);
+			data = data.subspan(length);
+		}
+	}
+
+	// one block with the fixed codes, not final
+	void put_fixed(std::span<const unsigned char> data) {
+		put_bits(0b010, 3);
+		detail::for_each_run_token(data, [this](unsigned char byte, int length) {
+			if (length == 0) {
+				put_symbol(byte);
+				return;
+			}
+			const auto index = detail::get_length_index(length);
+			put_symbol(257 + index);
+			put_bits(static_cast<uint32_t>(length - detail::length_base[index]), detail::length_extra_bits[index]);
+			// distance 1 is distance code 0
+			put_code(0, 5);
+		});
+		put_symbol(end_of_block);
+	}
+
+	void write_chunk(const char (&type)[5]) {
+		const auto* type_bytes = reinterpret_cast<const unsigned char*>(type);
+		const auto length = static_cast<uint32_t>(_chunk.size());
+		const uint32_t crc = crc32(_chunk, crc32({type_bytes, 4}));
+		const unsigned char header[] = {static_cast<unsigned char>(length >> 24), static_cast<unsigned char>(length >> 16), static_cast<unsigned char>(length >> 8), static_cast<unsigned char>(length), type_bytes[0], type_bytes[1], type_bytes[2], type_bytes[3]};
+		const unsigned char footer[] = {static_cast<unsigned char>(crc >> 24), static_cast<unsigned char>(crc >> 16), static_cast<unsigned char>(crc >> 8), static_cast<unsigned char>(crc)};
+		_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		_file.write(reinterpret_cast<const char*>(_chunk.data()), static_cast<std::streamsize>(_chunk.size()));
+		_file.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+	}
+
+	std::ofstream _file;
+	image_format _format;
+	int _width;
+	int _height;
+	int _channels;
+	int _rows = 0;
+	bool _started = false;
+	bool _ok = false;
+	uint32_t _adler = 1;
+	uint64_t _bits = 0;
+	int _bit_count = 0;
+	// the filtered rows and the chunk data, reused for every band
+	std::vector<unsigned char> _band;
+	std::vector<unsigned char> _chunk;
+};
+
+// fills the pixels of row y
+using row_renderer = std::function<void(int y, std::span<unsigned char> row)>;
+
+// Renders bands of rows in parallel and writes each band as soon as the bands above it are
+// written, so memory is one band per thread whatever the image size. The renderer is called
+// concurrently for different rows; with one thread the rows are rendered top to bottom. The
+// first exception of a renderer stops all threads and is rethrown once they are joined.
+inline bool render_image(const std::string& path, int width, int height, int channels, const row_renderer& render, unsigned int threads, int band_rows = 64) {
+	image_writer writer(path, width, height, channels);
+	const int bands = (height + band_rows - 1) / band_rows;
+	threads = std::clamp(threads, 1u, static_cast<unsigned int>(std::max(bands, 1)));
+	// at most one band per thread is not written yet, band b always uses buffer b % threads
+	std::vector<std::vector<unsigned char>> buffers(threads, std::vector<unsigned char>(writer.row_size() * band_rows));
+	std::atomic<int> next_band{0};
+	std::atomic<bool> aborted{false};
+	int written = 0;
+	std::exception_ptr error;
+	std::mutex mutex;
+	std::condition_variable cv;
+	const auto fail = [&](std::exception_ptr e) {
+		std::lock_guard lock(mutex);
+		if (!error) {
+			error = e;
+		}
+		aborted = true;
+		cv.notify_all();
+	};
+	const auto work = [&] {
+		try {
+			for (int band = next_band++; band < bands && !aborted; band = next_band++) {
+				const int from = band * band_rows;
+				const int to = std::min(height, from + band_rows);
+				auto& buffer = buffers[band % threads];
+				for (int y = from; y < to; ++y) {
+					render(y, std::span(buffer).subspan((y - from) * writer.row_size(), writer.row_size()));
+				}
+				std::unique_lock lock(mutex);
+				cv.wait(lock, [&] { return written == band || aborted; });
+				if (aborted) {
+					return;
+				}
+				writer.write_rows(std::span<const unsigned char>(buffer).first((to - from) * writer.row_size()));
+				++written;
+				cv.notify_all();
+			}
+		} catch (...) {
+			fail(std::current_exception());
+		}
+	};
+	std::vector<std::thread> workers;
+	try {
+		for (unsigned int i = 1; i < threads; ++i) {
+			workers.emplace_back(work);
+		}
+	} catch (...) {
+		fail(std::current_exception());
+	}
+	work();
+	for (auto& t : workers) {
+		t.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	return writer.close();
+}
+
+// grey pixels of the bytes of consecutive values, lowest byte first
+template <typename T>
+void to_grey_pixels(std::span<const T> values, std::span<unsigned char> pixels) {
+	assertion(pixels.size() == values.size() * sizeof(T), "pixels do not match the values");
+	for (std::size_t i = 0; i < values.size(); ++i) {
+		for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+			pixels[i * sizeof(T) + byte] = static_cast<unsigned char>(values[i] >> (8 * byte));
+		}
+	}
+}
+
+// the bytes of the stream as a grey image, the width has to be a multiple of the value size
+template <typename T>
+bool write_image(const std::string& path, stream<T> source, int width, int height) {
+	assertion(width % sizeof(T) == 0, "image width is not a multiple of the value size");
+	std::vector<T> values(width / sizeof(T));
+	return render_image(path, width, height, 1, [&](int, std::span<unsigned char> row) {
+		source.fill(values);
+		to_grey_pixels<T>(values, row);
+	}, 1);
 }
 
 }
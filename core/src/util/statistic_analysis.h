@@ -25,11 +25,12 @@ inline std::vector<double> to_p_values(const std::vector<test_result>& results)
 	return statistics;
 }
 
-inline double get_comparable_p_value(const statistic& stat) {
-	if (stat.type == statistic_type::z_score) {
-		return stat.p_value;
+inline p_value_histogram to_p_value_histogram(const std::vector<test_result>& results) {
+	p_value_histogram histogram(p_value_histogram::default_bin_count);
+	for (const auto& r : results) {
+		histogram.add(r.stats.p_value);
 	}
-	return std::min(stat.p_value, 1. - stat.p_value);
+	return histogram;
 }
 
 inline test_result get_worst_result(const std::vector<test_result>& test_results) {
@@ -95,7 +96,7 @@ public:
 };
 
 inline statistic_analysis create_uniform_p_values_analysis(const std::vector<test_result>& test_results) {
-	return statistic_analysis(*kolmogorov_smirnov_stats(to_p_values(test_results)));
+	return statistic_analysis(*kolmogorov_smirnov_stats(to_p_value_histogram(test_results)));
 }
 
 inline statistic_analysis create_statistic_analysis(const std::vector<test_result>& test_results) {
@@ -125,37 +126,84 @@ struct result_analysis {
 	std::string stream_name;
 	test_key test_id;
 	statistic_analysis analysis;
-	std::vector<test_result> results;
+	// points into the analysed battery result
+	const std::vector<test_result>* results;
 
 
 	std::string to_string() const {
 		return p_value_to_string(analysis.stat.p_value) + " " + analysis.to_string() + " " + stream_name;
 	}
 
+	// equal p-values by test name, so the order does not depend on when the names were interned
 	bool operator <(const result_analysis& rhs) const {
-		return get_comparable_p_value(analysis.stat) < get_comparable_p_value(rhs.analysis.stat);
+		const auto p = get_comparable_p_value(analysis.stat);
+		const auto rhs_p = get_comparable_p_value(rhs.analysis.stat);
+		if (p != rhs_p) {
+			return p < rhs_p;
+		}
+		if (test_id.less_by_name(rhs.test_id)) {
+			return true;
+		}
+		if (rhs.test_id.less_by_name(test_id)) {
+			return false;
+		}
+		return analysis_type < rhs.analysis_type;
 	}
 };
 
+// Meta analysis of a key, computed once after results were added and kept in its summary. Up
+// to the exact limit the p-values of the results are sorted in a reused buffer, past it the
+// bins of the summary are used.
+inline statistic get_uniformity_statistic(const test_battery_result& battery_result, const test_key& key) {
+	const auto& summary = battery_result.summaries.at(key);
+	if (!summary.uniformity) {
+		if (summary.binned_p_values.empty()) {
+			thread_local std::vector<double> sorted;
+			sorted.clear();
+			for (const auto& r : battery_result.results.at(key)) {
+				sorted.push_back(r.stats.p_value);
+			}
+			std::sort(sorted.begin(), sorted.end());
+			summary.uniformity = kolmogorov_smirnov_stats_sorted(sorted);
+		}
+		else {
+			summary.uniformity = kolmogorov_smirnov_stats(summary.binned_p_values);
+		}
+	}
+	return *summary.uniformity;
+}
+
+inline std::string get_meta_analysis_name(const std::vector<test_result>& results) {
+	return "meta analysis over " + std::to_string(results.size()) + " samples";
+}
+
 inline std::vector<result_analysis> get_analysis(const test_battery_result& battery_result) {
 	std::vector<result_analysis> ras;
+	ras.reserve(battery_result.results.size() * 2);
 	for (const auto& e : battery_result.results) {
-		const auto worst = get_worst_result(e.second);
-		ras.push_back({result_analysis::type::Sample, worst.stream_name, e.first, statistic_analysis{worst.stats}, e.second});
+		const auto& worst = battery_result.worst(e.first);
+		ras.push_back({result_analysis::type::Sample, worst.stream_name.str(), e.first, statistic_analysis{worst.stats}, &e.second});
 
-		const auto analysis = create_uniform_p_values_analysis(e.second);
-		const auto name = "meta analysis over " + std::to_string(e.second.size()) + " samples";
-		ras.push_back({result_analysis::type::Meta, name, e.first, analysis, e.second});
+		const auto uniformity = get_uniformity_statistic(battery_result, e.first);
+		ras.push_back({result_analysis::type::Meta, get_meta_analysis_name(e.second), e.first, statistic_analysis{uniformity}, &e.second});
 	}
 	std::sort(ras.begin(), ras.end());
 	return ras;
 }
 
+// same as the front of get_analysis but without copies, linear in the keys once their
+// uniformity was computed for the pass
 inline std::optional<statistic_analysis> get_worst_statistic_analysis(const test_battery_result& battery_result) {
-	const auto ras = get_analysis(battery_result);
-	if (ras.empty()) {
-		return {};
+	std::optional<statistic_analysis> worst;
+	const auto update = [&worst](const statistic& stat) {
+		if (!worst || get_comparable_p_value(stat) < worst->get_p_value_cmp()) {
+			worst = statistic_analysis(stat);
+		}
+	};
+	for (const auto& e : battery_result.summaries) {
+		update(battery_result.worst(e.first).stats);
+		update(get_uniformity_statistic(battery_result, e.first));
 	}
-	return ras.front().analysis;
+	return worst;
 }
 }
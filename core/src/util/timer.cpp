@@ -0,0 +1,33 @@
+#include "timer.h"
+
+// the platform headers stay out of the translation units including timer.h
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace tfr {
+
+uint64_t thread_cpu_nanoseconds() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+		return 0;
+	}
+	const auto to_nanoseconds = [](const FILETIME& ft) {
+		return ((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) * 100;
+	};
+	return to_nanoseconds(kernel) + to_nanoseconds(user);
+#else
+	timespec ts{};
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return 0;
+	}
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 namespace tfr {
 
@@ -31,4 +32,21 @@ private:
 	std::chrono::steady_clock::time_point _start;
 };
 
+// cpu time consumed by the calling thread, 0 if the platform can not tell
+uint64_t thread_cpu_nanoseconds();
+
+// measures the cpu time of the thread it was created on
+class cpu_timer {
+public:
+	cpu_timer() : _start(thread_cpu_nanoseconds()) {
+	}
+
+	uint64_t nanoseconds() const {
+		return thread_cpu_nanoseconds() - _start;
+	}
+
+private:
+	uint64_t _start;
+};
+
 }
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+#include "evaluate.h"
+#include "format_result.h"
+#include "search/grid_search.h"
+#include "util/diagnostics.h"
+#include "util/fileutil.h"
+#include "util/ppm.h"
+
+namespace tfr {
+
+namespace diagnostics {
+constexpr uint64_t avalanche_samples = 1 << 16;
+// pixels per bit pair of the avalanche heatmap
+constexpr int heatmap_cell = 8;
+// larger --image-size is capped for the bit planes, 64 planes side by side would be 4 GiB at 8192
+constexpr int max_bit_plane_size = 1024;
+
+// The bit planes of mix(i) side by side, bit 0 on the left and white for 1, every row computes
+// its values once with the block kernel.
+template <typename T>
+bool write_bit_planes(const std::string& path, const mixer<T>& mixer, int size) {
+	constexpr int bits = bit_sizeof<T>();
+	const auto render = [&mixer, size](int y, std::span<unsigned char> row) {
+		thread_local std::vector<T> values;
+		values.resize(static_cast<std::size_t>(size));
+		const auto first = static_cast<uint64_t>(y) * size;
+		for (std::size_t x = 0; x < values.size(); ++x) {
+			values[x] = static_cast<T>(first + x);
+		}
+		mixer(std::span<T>(values));
+		for (int b = 0; b < bits; ++b) {
+			auto* plane = row.data() + static_cast<std::size_t>(b) * size;
+			for (int x = 0; x < size; ++x) {
+				plane[x] = ((values[x] >> b) & 1) ? 255 : 0;
+			}
+		}
+	};
+	return render_image(path, bits * size, size, 1, render, default_max_threads());
+}
+
+// density of (mix(i), mix(i + 1)) relative to a uniform scatter, mix(i) along x
+inline bool write_lag_density(const std::string& path, const std::vector<uint64_t>& lag, uint64_t pairs) {
+	const double expected = static_cast<double>(pairs) / (lag_size * lag_size);
+	const auto render = [&lag, expected](int y, std::span<unsigned char> row) {
+		// the first value bin is the column, large next values at the top
+		const auto next = static_cast<std::size_t>(lag_size - 1 - y);
+		for (std::size_t x = 0; x < row.size(); ++x) {
+			row[x] = to_density_grey(lag[x * lag_size + next], expected);
+		}
+	};
+	return render_image(path, lag_size, lag_size, 1, render, 1);
+}
+
+// flip probability of output bit x when input bit y is flipped, as deviation from 1/2 in sigma
+template <typename T>
+bool write_avalanche_heatmap(const std::string& path, const std::vector<uint64_t>& counts, uint64_t n) {
+	constexpr int bits = bit_sizeof<T>();
+	const double sigma = std::sqrt(static_cast<double>(n) / 4);
+	const auto render = [&counts, n, sigma](int y, std::span<unsigned char> row) {
+		const int input = y / heatmap_cell;
+		for (int output = 0; output < bits; ++output) {
+			const double z = (static_cast<double>(counts[input * bits + output]) - static_cast<double>(n) / 2) / sigma;
+			const auto color = to_bias_color(z);
+			for (int p = 0; p < heatmap_cell; ++p) {
+				std::copy(color.begin(), color.end(), row.begin() + (output * heatmap_cell + p) * 3);
+			}
+		}
+	};
+	return render_image(path, bits * heatmap_cell, bits * heatmap_cell, 3, render, 1);
+}
+}
+
+// Visual diagnostics of a mixer: its bit planes, a lag-1 scatter density and the avalanche
+// matrix as a heatmap. Prints the most biased input/output bit pair of the avalanche matrix.
+template <typename T>
+void write_diagnostics(const std::string& dir, const mixer<T>& mixer) {
+	constexpr int bits = bit_sizeof<T>();
+	const auto& cfg = get_config();
+	const int size = std::min(cfg.image_size, diagnostics::max_bit_plane_size);
+	const auto prefix = dir + mixer.name;
+	bool ok = true;
+
+	ok &= diagnostics::write_bit_planes<T>(prefix + "_bitplanes" + cfg.image_extension(), mixer, size);
+	const auto lag = diagnostics::generate_lag_parallel<T>(mixer, cfg.lag_samples);
+	ok &= diagnostics::write_lag_density(prefix + "_lag" + cfg.image_extension(), lag, cfg.lag_samples);
+
+	const auto n = diagnostics::avalanche_samples;
+	const auto counts = diagnostics::generate_bic_parallel<T>(mixer, n);
+	ok &= diagnostics::write_avalanche_heatmap<T>(prefix + "_avalanche" + cfg.image_extension(), counts, n);
+
+	const auto worst = std::max_element(counts.begin(), counts.end(), [n](uint64_t a, uint64_t b) {
+		return std::abs(static_cast<double>(a) - n / 2.) < std::abs(static_cast<double>(b) - n / 2.);
+	});
+	const auto index = static_cast<int>(worst - counts.begin());
+	std::cout << mixer.name << ": worst avalanche input bit " << index / bits << " output bit " << index % bits
+		<< " flips " << static_cast<double>(*worst) / n << (ok ? "" : ", failed to write an image") << "\n";
+}
+
+// -diagnostics for the known mixers or for the one given with --mixer
+template <typename T>
+void diagnostics_command() {
+	const auto& cfg = get_config();
+	const auto dir = cfg.diagnostics_dir<T>();
+	create_directories(dir);
+	if (cfg.image_size > diagnostics::max_bit_plane_size) {
+		std::cout << "--image-size " << cfg.image_size << " is clamped to " << diagnostics::max_bit_plane_size
+			<< " for the bit planes\n";
+	}
+	if (cfg.mixer.empty()) {
+		for (const auto& mixer : get_mixers<T>()) {
+			write_diagnostics<T>(dir, mixer);
+		}
+		return;
+	}
+	const auto slash = cfg.mixer.find('/');
+	const auto family = cfg.mixer.substr(0, slash);
+	const auto cell = slash == std::string::npos ? grid_cell{} : to_grid_cell(cfg.mixer.substr(slash + 1));
+	if (static_cast<int>(cell.size()) != get_shift_count(family) + 1 || cell.size() == 1) {
+		throw std::runtime_error("invalid mixer " + cfg.mixer + ", expected e.g. xm2x/16,15,16,2471660141");
+	}
+	auto mixer = create_grid_mixer<T>(family, cell);
+	mixer.name = family + "_" + to_string(cell);
+	write_diagnostics<T>(dir, mixer);
+}
+
+}
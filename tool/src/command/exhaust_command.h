@@ -1,55 +1,132 @@
 #pragma once
 
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
 #include "evaluate.h"
 #include "format_result.h"
-#include "search/mixer_constructions.h"
-#include "util/test_setups.h"
+#include "search/grid_search.h"
+#include "util/checkpoint.h"
+#include "util/remote.h"
 
 namespace tfr {
 
-inline void exhaust_command() {
+template <typename T>
+std::string get_exhaust_task_name() {
+	return "exhaust_" + std::to_string(bit_sizeof<T>());
+}
+
+// tasks for remote workers of the exhaust command, the payload is "family start stop cell"
+inline remote_tasks create_exhaust_tasks() {
 	using T = uint32_t;
-	const auto cb = [](const test_battery_result& br, bool) {
-		const auto analysis = get_worst_statistic_analysis(br);
-		if (!analysis) {
-			return true;
+	return {{get_exhaust_task_name<T>(), [](const std::string& payload) {
+		std::stringstream ss(payload);
+		grid_space space;
+		std::string cell;
+		ss >> space.family >> space.start_power_of_two >> space.stop_power_of_two >> cell;
+		return std::to_string(evaluate_grid_cell<T>(space, to_grid_cell(cell)));
+	}}};
+}
+
+namespace detail {
+// one cell per remote worker at a time, the workers evaluate all powers of a cell
+template <typename T>
+std::vector<grid_cell_result> run_remote_grid_search(const grid_space& space, checkpoint& completed, const grid_cell_callback& callback, remote_pool& pool) {
+	std::vector<grid_cell_result> results;
+	jobs<std::optional<grid_cell_result>> cell_jobs;
+	for (const auto& cell : get_grid_cells(space)) {
+		if (const auto stored = completed.get(to_string(cell))) {
+			results.push_back({cell, std::stoi(*stored)});
+			continue;
 		}
-		return analysis->pass();
+		cell_jobs.emplace_back([cell, &space, &pool]() -> std::optional<grid_cell_result> {
+			const auto payload = space.family + " " + std::to_string(space.start_power_of_two) + " " + std::to_string(space.stop_power_of_two) + " " + to_string(cell);
+			const auto result = pool.call(get_exhaust_task_name<T>(), payload);
+			const auto power_of_two = result ? protocol::parse_number<int>(*result) : std::nullopt;
+			if (!power_of_two) {
+				return {};
+			}
+			return grid_cell_result{cell, *power_of_two};
+		});
+	}
+	std::size_t failed = 0;
+	const auto collector = [&](const std::optional<grid_cell_result>& r) {
+		static std::mutex m;
+		std::lock_guard lg(m);
+		// failed cells stay out of the checkpoint and are evaluated again with --resume
+		if (!r) {
+			++failed;
+			return;
+		}
+		completed.add(to_string(r->cell), std::to_string(r->power_of_two));
+		results.push_back(*r);
+		callback(*r);
 	};
+	run_jobs<std::optional<grid_cell_result>>(cell_jobs, collector, static_cast<unsigned int>(get_config().workers));
+	if (failed > 0) {
+		std::cout << failed << " cells failed, run again with --resume to retry them\n";
+	}
+	return results;
+}
+}
 
-	struct res {
-		xm2x_constants<T> c;
-		test_battery_result result;
+// Finds how far every mixer of a grid of constants gets, by default the xm2x shifts 9-20,
+// 9-20, 9-19 with a fixed multiplier. Another grid can be given with --grid, see
+// parse_grid_space for the format.
+inline void exhaust_command() {
+	using T = uint32_t;
+	grid_space space;
+	if (!get_config().grid.empty()) {
+		const auto parsed = parse_grid_space(get_config().grid);
+		if (!parsed) {
+			std::cout << "Invalid grid " << get_config().grid << ", expected e.g. xm2x/9-20,9-20,9-19/2471660141\n";
+			return;
+		}
+		space = *parsed;
+	}
+	std::cout << "Exhausting " << get_grid_cells(space).size() << " " << space.family << " cells\n";
+
+	// completed grid cells and the power of two they reached, written as they finish, for this
+	// grid and range of powers only
+	auto checkpoint_name = "exhaust_" + to_string(space) + "_" + std::to_string(space.start_power_of_two) + "-" + std::to_string(space.stop_power_of_two);
+	std::replace(checkpoint_name.begin(), checkpoint_name.end(), '/', '_');
+	checkpoint completed(get_config().checkpoint_file_path(checkpoint_name), get_config().resume);
+	const auto print_cell = [](const grid_cell_result& r) {
+		std::cout << to_string(r.cell) << ": " << r.power_of_two << "\n";
 	};
 
-	std::vector<res> results;
+	std::vector<grid_cell_result> results;
+	// with --listen the cells are spread over the remote workers
+	if (get_config().listen_port != 0) {
+		remote_pool pool(get_config().listen_address, get_config().listen_port, get_config().token);
+		std::cout << "Waiting for " << get_config().workers << " workers on port " << pool.port() << "\n";
+		pool.wait_for_workers(get_config().workers);
+		results = detail::run_remote_grid_search<T>(space, completed, print_cell, pool);
+	}
+	else {
+		results = run_grid_search<T>(space, completed, print_cell);
+	}
+
+	// sums per value of the first shift
+	std::map<uint64_t, int> sums;
 	int total = 0;
-	for (T c1 = 9; c1 <= 20; ++c1) {
-		int sum = 0;
-		std::cout << c1 << "-\n";
-		for (T c2 = 9; c2 <= 20; ++c2) {
-			for (T c3 = 9; c3 < 20; ++c3) {
-				const xm2x_constants<T> c{c1, c2, c3, 2471660141};
-				const auto mixer = create_xm2x_mixer<T>(c);
-				const auto r = evaluate_multi_pass<T>(cb, create_mixer_test_setup<T>(mixer).range(10, 27));
-				results.push_back({c, r});
-				sum += r.power_of_two();
-				std::cout << r.power_of_two() << ";";
-			}
-			std::cout << "\n";
-		}
-		total += sum;
-		std::cout << "sum: " << sum << "\n\n";
+	for (const auto& r : results) {
+		sums[r.cell.front()] += r.power_of_two;
+		total += r.power_of_two;
+	}
+	for (const auto& e : sums) {
+		std::cout << e.first << "- sum: " << e.second << "\n";
 	}
 	std::cout << "total: " << total << "\n\n";
 
-	std::sort(results.begin(), results.end(), [](const res& a, const res& b) {
-		return a.result.power_of_two() > b.result.power_of_two();
+	std::sort(results.begin(), results.end(), [](const grid_cell_result& a, const grid_cell_result& b) {
+		return a.power_of_two > b.power_of_two;
 	});
 
 	int i = 0;
 	for (const auto& r : results) {
-		std::cout << r.result.power_of_two() << "\n";
+		std::cout << to_string(r.cell) << ": " << r.power_of_two << "\n";
 		if (++i > 20) break;
 	}
 }
@@ -1,22 +1,40 @@
 #pragma once
 
+#include "util/fileutil.h"
 #include "util/ppm.h"
 
 namespace tfr {
 
+// The bytes of every mixer applied to a counter as a grey image, rendered in parallel bands
+// with the block kernel of the mixer, large sizes never hold the whole image in memory.
 template <typename T>
 void ppm_command() {
-	const auto dir = get_config().root_path + "ppm" + std::to_string(bit_sizeof<T>()) + "/";
+	const auto& cfg = get_config();
+	const auto dir = cfg.ppm_dir<T>();
+	if (cfg.image_size < static_cast<int>(sizeof(T))) {
+		throw std::runtime_error("image size " + std::to_string(cfg.image_size) + " is smaller than a value of " + std::to_string(sizeof(T)) + " bytes");
+	}
+	create_directories(dir);
+	const int size = cfg.image_size - cfg.image_size % static_cast<int>(sizeof(T));
 	if (auto trng_stream = create_trng_stream<T>()) {
-		write_ppm(dir + trng_stream->name + ".ppm", *trng_stream);
+		write_image(dir + trng_stream->name + cfg.image_extension(), *trng_stream, size, size);
 	}
 
+	const auto values_per_row = static_cast<std::size_t>(size) / sizeof(T);
 	for (const auto& mix : get_mixers<T>()) {
-		constexpr int size = 512;
-		write_ppm<T>(
-			dir + mix.name + ".ppm",
-			size, size,
-			[&mix](T x, T y) { return mix.mix(y * size + x); });
+		const auto render = [&mix, values_per_row](int y, std::span<unsigned char> row) {
+			thread_local std::vector<T> values;
+			values.resize(values_per_row);
+			for (std::size_t x = 0; x < values_per_row; ++x) {
+				values[x] = static_cast<T>(y * values_per_row + x);
+			}
+			mix(std::span<T>(values));
+			to_grey_pixels<T>(values, row);
+		};
+		const auto path = dir + mix.name + cfg.image_extension();
+		if (!render_image(path, size, size, 1, render, default_max_threads())) {
+			std::cout << "Failed to write " << path << "\n";
+		}
 	}
 }
 
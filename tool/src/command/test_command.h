@@ -5,6 +5,7 @@
 #include "combiners32.h"
 #include "combiners64.h"
 #include "evaluate.h"
+#include "export_result.h"
 #include "format_result.h"
 #include "mixers8.h"
 #include "mixers16.h"
@@ -14,6 +15,8 @@
 #include "prngs16.h"
 #include "prngs32.h"
 #include "prngs64.h"
+#include "util/checkpoint.h"
+#include "util/job_profile.h"
 #include "util/test_setups.h"
 
 namespace tfr {
@@ -42,53 +45,221 @@ inline auto create_result_callback(bool print_intermediate_results = true, const
 	};
 }
 
+// subjects of all word sizes run concurrently, their printed results and file rows are written
+// under this one lock to keep them in one piece
+inline std::mutex& get_result_output_mutex() {
+	static std::mutex m;
+	return m;
+}
+
+// one job per test subject (trng, drng, mixers, prngs and combiners), all test jobs run on the given pool
 template <typename T>
-void test_command() {
-	constexpr int max_power_of_two = 25;
+jobs<bool> create_test_subject_jobs(const std::shared_ptr<job_pool>& pool) {
+	static constexpr int max_power_of_two = 25;
+	const auto& cfg = get_config();
+
+	// completed subjects, the interrupted subject resumes from the result cache
+	const auto completed = std::make_shared<checkpoint>(cfg.checkpoint_file_path("test" + std::to_string(bit_sizeof<T>())), cfg.resume);
 
-	on_done_callback on_done;
+	std::string report_filename;
+	std::string json_filename;
+	std::string timing_filename;
+	std::shared_ptr<const result_cache> cache;
 	if (!is_debug()) {
-		const auto report_filename = get_config().test_result_file_path<T>();
-		std::ostringstream os;
-		os << "# " << bit_sizeof<T>() << "-bit results\n";
-		os << "_While TFR is new you should take the results with a grain of salt._\n\n";
-		os << "Tests stop when 2^" << max_power_of_two << " stream elements have been tested. A failed test with '*' suffix indicates the meta analysis failed (non uniform p-values).\n\n";
-		os << "Source|TFR|Failures|\n-|-|-|\n";
-		write(report_filename, os.str());
-		on_done = [report_filename](const test_battery_result& br, bool pass) {
+		cache = std::make_shared<result_cache>(cfg.cache_dir());
+		report_filename = cfg.test_result_file_path<T>();
+		// a resumed run appends to the report of the interrupted one
+		if (!cfg.resume || !file_exists(report_filename)) {
 			std::ostringstream os;
-			os << escape_for_md(br.test_subject_name) << "|"
-				<< (pass ? ">" : "") << br.power_of_two() << "|"
-				<< join(get_failed_tests(get_analysis(br)), ", ") << "\n";
-			write_append(report_filename, os.str());
-		};
+			os << "# " << bit_sizeof<T>() << "-bit results\n";
+			os << "_While TFR is new you should take the results with a grain of salt._\n\n";
+			os << "Tests stop when 2^" << max_power_of_two << " stream elements have been tested. A failed test with '*' suffix indicates the meta analysis failed (non uniform p-values).\n\n";
+			os << "Source|TFR|Failures|\n-|-|-|\n";
+			for (const auto& e : completed->entries()) {
+				os << e.second << "\n";
+			}
+			write(report_filename, os.str());
+		}
+		json_filename = cfg.test_result_json_file_path<T>();
+		timing_filename = cfg.test_timing_json_file_path<T>();
+		if (!cfg.resume) {
+			write(json_filename, "");
+			write(timing_filename, "");
+		}
 	}
 
-	const auto callback = create_result_callback(true, on_done);
+	const on_done_callback on_done = [report_filename, completed](const test_battery_result& br, bool pass) {
+		std::ostringstream os;
+		os << escape_for_md(br.test_subject_name) << "|"
+			<< (pass ? ">" : "") << br.power_of_two() << "|"
+			<< join(get_failed_tests(get_analysis(br)), ", ");
+		if (!report_filename.empty()) {
+			write_append(report_filename, os.str() + "\n");
+		}
+		completed->add(br.test_subject_name, os.str());
+	};
+
+	const auto result_callback = create_result_callback(true, on_done);
+	const auto callback = [result_callback, json_filename, timing_filename](const test_battery_result& br, bool is_last) {
+		std::lock_guard lg(get_result_output_mutex());
+		get_job_profile().add(br);
+		if (!json_filename.empty()) {
+			write_append(json_filename, to_json_lines(br));
+			write_append(timing_filename, to_json_timing_lines(br));
+		}
+		return result_callback(br, is_last);
+	};
+
+	std::vector<std::function<test_setup<T>()>> create_setups;
 	const auto file_ns = "file" + std::to_string(bit_sizeof<T>()) + "::";
 	// trng
 	if (const auto& data = get_trng_data<T>()) {
-		evaluate_multi_pass(callback, create_data_test_setup(file_ns + "trng", *data).range(10, std::min(max_power_of_two, 22)));
+		create_setups.emplace_back([file_ns, data] {
+			return create_data_test_setup(file_ns + "trng", *data).range(10, std::min(max_power_of_two, 22));
+		});
 	}
 
 	// drng
 	if (const auto& data = get_drng_data<T>()) {
-		evaluate_multi_pass(callback, create_data_test_setup(file_ns + "drng", *data).range(10, std::min(max_power_of_two, 27)));
+		create_setups.emplace_back([file_ns, data] {
+			return create_data_test_setup(file_ns + "drng", *data).range(10, std::min(max_power_of_two, 27));
+		});
 	}
 
 	// mixers
 	for (const auto& m : get_mixers<T>()) {
-		evaluate_multi_pass(callback, create_mixer_test_setup(m).range(10, max_power_of_two));
+		create_setups.emplace_back([m] {
+			return create_mixer_test_setup(m).range(10, max_power_of_two);
+		});
 	}
 
 	// prngs
 	for (const auto& prng : get_prngs<T>()) {
-		evaluate_multi_pass(callback, create_prng_test_setup<T>(prng).range(10, max_power_of_two));
+		create_setups.emplace_back([prng] {
+			return create_prng_test_setup<T>(prng).range(10, max_power_of_two);
+		});
 	}
 
 	// combiners
 	for (const auto& combiner : get_combiners<T>()) {
-		evaluate_multi_pass(callback, create_combiner_test_setup<T>(combiner).range(10, max_power_of_two));
+		create_setups.emplace_back([combiner] {
+			return create_combiner_test_setup<T>(combiner).range(10, max_power_of_two);
+		});
+	}
+
+	const auto is_completed = [completed](const test_setup<T>& setup) {
+		if (completed->contains(setup.test_subject_name)) {
+			std::cout << "Skipping " << setup.test_subject_name << ", completed in previous run\n";
+			return true;
+		}
+		return false;
+	};
+
+	jobs<bool> subjects;
+	if (cfg.breadth_first) {
+		// all subjects of this word size in one job, raised one power at a time
+		subjects.emplace_back([create_setups, is_completed, callback, cache, pool, profile = cfg.profile] {
+			std::vector<test_setup<T>> setups;
+			for (const auto& create_setup : create_setups) {
+				auto setup = create_setup();
+				if (!is_completed(setup)) {
+					setups.push_back(setup.set_cache(cache).set_pool(pool).set_profile(profile));
+				}
+			}
+			evaluate_breadth_first<T>(callback, setups);
+			return true;
+		});
+		return subjects;
+	}
+
+	for (const auto& create_setup : create_setups) {
+		subjects.emplace_back([create_setup, is_completed, callback, cache, pool, profile = cfg.profile] {
+			auto setup = create_setup();
+			if (!is_completed(setup)) {
+				evaluate_multi_pass(callback, setup.set_cache(cache).set_pool(pool).set_profile(profile));
+			}
+			return true;
+		});
 	}
+	return subjects;
+}
+
+inline void run_test_subjects(const std::vector<jobs<bool>>& subjects_per_type, unsigned int concurrent_subjects) {
+	// interleave the word sizes, run_jobs takes jobs from the back
+	jobs<bool> subjects;
+	for (std::size_t i = 0; ; ++i) {
+		bool added = false;
+		for (const auto& type_subjects : subjects_per_type) {
+			if (i < type_subjects.size()) {
+				subjects.push_back(type_subjects[i]);
+				added = true;
+			}
+		}
+		if (!added) {
+			break;
+		}
+	}
+	std::reverse(subjects.begin(), subjects.end());
+	run_jobs<bool>(subjects, [](bool) {}, concurrent_subjects);
+}
+
+inline unsigned int default_concurrent_subjects(const job_pool& pool) {
+	// enough subjects in flight to fill the pool while some are down to their last long jobs,
+	// but never more than there are workers
+	return std::min(std::max(2u, pool.size() / 4), pool.size());
+}
+
+template <typename T>
+void calibrate_test_cost_model() {
+	const auto& model = get_cost_model();
+	// only the tests without samples, e.g. ones added since the model was saved
+	std::vector<test_type> missing;
+	for (const auto type : default_test_types) {
+		if (model.get(type, bit_sizeof<T>()).samples == 0) {
+			missing.push_back(type);
+		}
+	}
+	if (missing.empty()) {
+		return;
+	}
+	std::cout << "Calibrating cost model for " << bit_sizeof<T>() << "-bits...\n";
+	calibrate_cost_model(create_mixer_test_setup(get_default_mixer<T>()).set_tests(missing));
+}
+
+inline void run_test_command(const std::function<std::vector<jobs<bool>>(const std::shared_ptr<job_pool>&)>& create_subjects) {
+	const auto& cfg = get_config();
+	get_cost_model().load(cfg.cost_model_file_path());
+	if (cfg.profile && !perf_counters::is_supported()) {
+		std::cout << "Warning: perf counters are not available, profiling job times only.\n";
+	}
+	const auto pool = std::make_shared<job_pool>(default_max_threads());
+	run_test_subjects(create_subjects(pool), default_concurrent_subjects(*pool));
+	get_cost_model().save(cfg.cost_model_file_path());
+	if (cfg.profile) {
+		get_job_profile().print();
+	}
+}
+
+template <typename T>
+void test_command() {
+	run_test_command([](const std::shared_ptr<job_pool>& pool) {
+		calibrate_test_cost_model<T>();
+		return std::vector{create_test_subject_jobs<T>(pool)};
+	});
+}
+
+inline void test_command() {
+	run_test_command([](const std::shared_ptr<job_pool>& pool) {
+		calibrate_test_cost_model<uint8_t>();
+		calibrate_test_cost_model<uint16_t>();
+		calibrate_test_cost_model<uint32_t>();
+		calibrate_test_cost_model<uint64_t>();
+		return std::vector{
+			create_test_subject_jobs<uint8_t>(pool),
+			create_test_subject_jobs<uint16_t>(pool),
+			create_test_subject_jobs<uint32_t>(pool),
+			create_test_subject_jobs<uint64_t>(pool),
+		};
+	});
 }
 }
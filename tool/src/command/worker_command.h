@@ -0,0 +1,20 @@
+#pragma once
+
+#include "exhaust_command.h"
+#include "search/search_command.h"
+#include "util/remote.h"
+
+namespace tfr {
+
+// runs tasks for a coordinator started with -search or -exhaust and --listen
+inline void worker_command() {
+	const auto& cfg = get_config();
+	auto tasks = create_search_tasks<uint32_t>();
+	tasks.merge(create_exhaust_tasks());
+	std::cout << "Connecting to " << cfg.coordinator_host << ":" << cfg.coordinator_port << "\n";
+	if (!run_remote_worker(cfg.coordinator_host, cfg.coordinator_port, cfg.token, tasks)) {
+		std::cout << "Could not connect to the coordinator\n";
+	}
+}
+
+}
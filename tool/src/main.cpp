@@ -1,11 +1,15 @@
+#include <charconv>
 #include <iostream>
+#include <stdexcept>
 
 #include "evaluate.h"
 #include "trng_data.h"
+#include "command/diagnostics_command.h"
 #include "command/exhaust_command.h"
 #include "command/inspect_test_command.h"
 #include "command/ppm_command.h"
 #include "command/test_command.h"
+#include "command/worker_command.h"
 #include "search/search_command.h"
 
 namespace tfr {
@@ -34,25 +38,116 @@ void export_rdrand(int power_of_two) {
 	write_binary(cfg.drng_file_path(), data, true);
 }
 
+const char* usage = "Usage: tfr-tool.exe root-path command [--resume] [--breadth-first] [--profile] [--genetic] [--evaluations n] [--population n] [--racing] [--listen [address:]port] [--token secret] [--workers n] [--connect host:port] [--grid family/shifts/multipliers] [--image-size n] [--png] [--lag-samples n] [--mixer family/constants]\n";
+
+// an invalid option, printed with the usage
+class option_error : public std::invalid_argument {
+public:
+	using std::invalid_argument::invalid_argument;
+};
+
+// all of the text as a number of at least min, throws option_error otherwise
+template <typename T>
+T parse_option_number(const std::string& option, const std::string& text, T min = std::numeric_limits<T>::min()) {
+	T value{};
+	const auto* end = text.data() + text.size();
+	const auto r = std::from_chars(text.data(), end, value);
+	if (r.ec != std::errc() || r.ptr != end || value < min) {
+		throw option_error("Invalid value " + text + " for " + option);
+	}
+	return value;
+}
+
+// the config of the options after the command, throws option_error for invalid options
+config parse_options(int argc, char** args) {
+	config cfg{args[1]};
+	for (int i = 3; i < argc; ++i) {
+		const std::string option = args[i];
+		if (option == "--resume") {
+			cfg.resume = true;
+		}
+		else if (option == "--breadth-first") {
+			cfg.breadth_first = true;
+		}
+		else if (option == "--profile") {
+			cfg.profile = true;
+		}
+		else if (option == "--genetic") {
+			cfg.genetic = true;
+		}
+		else if (option == "--evaluations" && i + 1 < argc) {
+			cfg.genetic_evaluations = parse_option_number<uint64_t>(option, args[++i], 1);
+		}
+		else if (option == "--population" && i + 1 < argc) {
+			cfg.genetic_population = parse_option_number<std::size_t>(option, args[++i], 2);
+		}
+		else if (option == "--racing") {
+			cfg.racing = true;
+		}
+		else if (option == "--grid" && i + 1 < argc) {
+			cfg.grid = args[++i];
+		}
+		else if (option == "--listen" && i + 1 < argc) {
+			const std::string address = args[++i];
+			const auto colon = address.rfind(':');
+			if (colon != std::string::npos) {
+				cfg.listen_address = address.substr(0, colon);
+			}
+			cfg.listen_port = parse_option_number<uint16_t>(option, address.substr(colon == std::string::npos ? 0 : colon + 1));
+		}
+		else if (option == "--token" && i + 1 < argc) {
+			cfg.token = args[++i];
+		}
+		else if (option == "--workers" && i + 1 < argc) {
+			cfg.workers = parse_option_number(option, args[++i], 1);
+		}
+		else if (option == "--image-size" && i + 1 < argc) {
+			cfg.image_size = parse_option_number(option, args[++i], 1);
+		}
+		else if (option == "--png") {
+			cfg.png = true;
+		}
+		else if (option == "--lag-samples" && i + 1 < argc) {
+			cfg.lag_samples = parse_option_number<uint64_t>(option, args[++i], 1);
+		}
+		else if (option == "--mixer" && i + 1 < argc) {
+			cfg.mixer = args[++i];
+		}
+		else if (option == "--connect" && i + 1 < argc) {
+			const std::string address = args[++i];
+			const auto colon = address.rfind(':');
+			if (colon == std::string::npos) {
+				throw option_error("Expected host:port for --connect");
+			}
+			cfg.coordinator_host = address.substr(0, colon);
+			cfg.coordinator_port = parse_option_number<uint16_t>(option, address.substr(colon + 1));
+		}
+		else {
+			throw option_error("Unknown option " + option);
+		}
+	}
+	// anyone who can connect can run tasks, so other machines have to know the token
+	if (cfg.listen_port != 0 && !is_loopback_address(cfg.listen_address) && cfg.token.empty()) {
+		throw option_error("Listening on " + cfg.listen_address + " requires a --token");
+	}
+	return cfg;
+}
+
 }
 
 int main(int argc, char** args) {
 	using namespace tfr;
 	try {
-		if (argc != 3) {
-			std::cout << "Usage: tfr-tool.exe root-path command\n";
+		if (argc < 3) {
+			std::cout << usage;
 			return 1;
 		}
-		const std::string root_path = args[1];
-		set_config({root_path});
+		set_config(parse_options(argc, args));
 
 		const std::string command = args[2];
 		std::cout << "Executing command " << command << "\n";
 		if (command == "-test") {
-			test_command<uint8_t>();
-			test_command<uint16_t>();
-			test_command<uint32_t>();
-			test_command<uint64_t>();
+			test_command();
 			return 0;
 		}
 		if (command == "-search") {
@@ -76,16 +171,31 @@ int main(int argc, char** args) {
 			ppm_command<T>();
 			return 0;
 		}
+		if (command == "-diagnostics") {
+			using T = uint32_t;
+			diagnostics_command<T>();
+			return 0;
+		}
 		if (command == "-exhaust") {
 			exhaust_command();
 			return 0;
 		}
+		if (command == "-worker") {
+			worker_command();
+			return 0;
+		}
 
 		std::cout << "Unknown command\n";
 		return 1;
 	}
-	catch (std::runtime_error& e) {
+	catch (const option_error& e) {
+		std::cout << e.what() << "\n" << usage;
+		return 1;
+	}
+	// also invalid numbers in --grid or --mixer
+	catch (const std::exception& e) {
 		std::cout << "ERROR: " << e.what() << "\n";
+		return 1;
 	}
 	return 0;
 }
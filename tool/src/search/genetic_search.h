@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "util/sffs.h"
+
+namespace tfr {
+
+struct genetic_config {
+	std::size_t population = 32;
+	uint64_t evaluations = 1000;
+	// tournament size for the parent selection
+	std::size_t tournament = 3;
+	// expected number of flipped bits per child
+	double mutations = 1.5;
+	uint64_t seed = 1234;
+	unsigned int threads = default_max_threads();
+};
+
+// Asynchronous steady state genetic algorithm over the bits of a sffs_config. Every worker
+// breeds a child from the current population, evaluates it without holding any lock and
+// replaces the worst member if the child is better. There are no generations to wait for,
+// so all workers stay busy until the evaluation budget is used up. The callback is called
+// with the number of evaluations whenever the best state improves.
+class genetic_search {
+public:
+	genetic_search(const sffs_config& config, const genetic_config& genetic) : _config(config), _genetic(genetic), _random(genetic.seed) {
+		assertion(_genetic.population >= 2, "genetic search needs a population of at least 2");
+		if (const auto& seed = config.seed) {
+			_pending.push_back(*seed);
+		}
+	}
+
+	sffs_state run(const sffs_callback& callback) {
+		std::vector<std::thread> threads;
+		for (unsigned int i = 0; i < std::max(_genetic.threads, 1u); ++i) {
+			threads.emplace_back([this, &callback] {
+				try {
+					while (const auto candidate = next_candidate()) {
+						const double score = _config.fitness(*candidate);
+						assertion(is_valid(score), "invalid fitness score for genetic search");
+						add({*candidate, score}, callback);
+					}
+				}
+				catch (...) {
+					std::lock_guard lg(_mutex);
+					if (!_error) {
+						_error = std::current_exception();
+					}
+				}
+			});
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+		// the first failed evaluation stops the search
+		if (_error) {
+			std::rethrow_exception(_error);
+		}
+		return _best;
+	}
+
+private:
+	std::optional<bit_vector> next_candidate() {
+		std::lock_guard lg(_mutex);
+		if (_started >= _genetic.evaluations || _error) {
+			return {};
+		}
+		++_started;
+		++_running;
+		if (!_pending.empty()) {
+			auto candidate = _pending.back();
+			_pending.pop_back();
+			return candidate;
+		}
+		// fill the population with random members before breeding
+		if (_population.size() + _running <= _genetic.population || _population.size() < 2) {
+			return random_candidate();
+		}
+		return mutate(crossover(select(), select()));
+	}
+
+	void add(const sffs_state& state, const sffs_callback& callback) {
+		std::lock_guard lg(_mutex);
+		--_running;
+		++_completed;
+		for (const auto& member : _population) {
+			if (member.data == state.data) {
+				return;
+			}
+		}
+		if (_population.size() < _genetic.population) {
+			_population.push_back(state);
+		}
+		else {
+			auto worst = std::max_element(_population.begin(), _population.end(), by_score);
+			if (state.score >= worst->score) {
+				return;
+			}
+			*worst = state;
+		}
+		if (state.score < _best.score) {
+			const auto old_best = _best;
+			_best = state;
+			if (callback) {
+				callback(static_cast<int>(_completed), _best, old_best);
+			}
+		}
+	}
+
+	static bool by_score(const sffs_state& a, const sffs_state& b) {
+		return a.score < b.score;
+	}
+
+	bit_vector random_candidate() {
+		bit_vector bits(_config.bits);
+		for (int i = 0; i < _config.bits; ++i) {
+			bits.set_bit(i, (_random() & 1) == 1);
+		}
+		return bits;
+	}
+
+	const bit_vector& select() {
+		std::uniform_int_distribution<std::size_t> index(0, _population.size() - 1);
+		const sffs_state* winner = &_population[index(_random)];
+		for (std::size_t i = 1; i < _genetic.tournament; ++i) {
+			const auto& other = _population[index(_random)];
+			if (other.score < winner->score) {
+				winner = &other;
+			}
+		}
+		return winner->data;
+	}
+
+	bit_vector crossover(const bit_vector& a, const bit_vector& b) {
+		bit_vector child(_config.bits);
+		for (int i = 0; i < _config.bits; ++i) {
+			child.set_bit(i, (_random() & 1) == 1 ? a.get_bit(i) : b.get_bit(i));
+		}
+		return child;
+	}
+
+	bit_vector mutate(bit_vector bits) {
+		std::bernoulli_distribution flip(std::min(1., _genetic.mutations / _config.bits));
+		for (int i = 0; i < _config.bits; ++i) {
+			if (flip(_random)) {
+				bits.set_bit(i, !bits.get_bit(i));
+			}
+		}
+		return bits;
+	}
+
+	const sffs_config& _config;
+	genetic_config _genetic;
+	std::mt19937_64 _random;
+	std::mutex _mutex;
+	std::vector<sffs_state> _population;
+	std::vector<bit_vector> _pending;
+	sffs_state _best;
+	uint64_t _started{};
+	uint64_t _completed{};
+	std::size_t _running{};
+	std::exception_ptr _error;
+};
+
+inline sffs_state run_genetic_search(const sffs_config& config, const genetic_config& genetic, const sffs_callback& callback) {
+	return genetic_search(config, genetic).run(callback);
+}
+
+}
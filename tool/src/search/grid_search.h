@@ -0,0 +1,201 @@
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "evaluate.h"
+#include "mixer_constructions.h"
+#include "util/checkpoint.h"
+#include "util/test_setups.h"
+
+namespace tfr {
+
+// Grid of mixer constants: every combination of the shift ranges and multipliers of a family.
+struct grid_space {
+	std::string family = "xm2x";
+	// inclusive, one per shift of the family
+	std::vector<std::pair<uint64_t, uint64_t>> shift_ranges{{9, 20}, {9, 20}, {9, 19}};
+	std::vector<uint64_t> multipliers{2471660141};
+	int start_power_of_two = 10;
+	int stop_power_of_two = 27;
+};
+
+// the shift values followed by the multiplier
+using grid_cell = std::vector<uint64_t>;
+
+struct grid_cell_result {
+	grid_cell cell;
+	int power_of_two{};
+};
+
+inline int get_shift_count(const std::string& family) {
+	if (family == "xmx") return 2;
+	if (family == "xm2x") return 3;
+	if (family == "xm3x") return 4;
+	return 0;
+}
+
+inline std::vector<grid_cell> get_grid_cells(const grid_space& space) {
+	std::vector<grid_cell> cells{{}};
+	for (const auto& range : space.shift_ranges) {
+		std::vector<grid_cell> extended;
+		for (const auto& cell : cells) {
+			for (auto s = range.first; s <= range.second; ++s) {
+				extended.push_back(cell);
+				extended.back().push_back(s);
+			}
+		}
+		cells = std::move(extended);
+	}
+	std::vector<grid_cell> with_multipliers;
+	for (const auto& cell : cells) {
+		for (const auto m : space.multipliers) {
+			with_multipliers.push_back(cell);
+			with_multipliers.back().push_back(m);
+		}
+	}
+	return with_multipliers;
+}
+
+// "c1,c2,...,m1", also the checkpoint key of a cell
+inline std::string to_string(const grid_cell& cell) {
+	std::string s;
+	for (const auto v : cell) {
+		s += (s.empty() ? "" : ",") + std::to_string(v);
+	}
+	return s;
+}
+
+inline grid_cell to_grid_cell(const std::string& s) {
+	grid_cell cell;
+	std::stringstream ss(s);
+	std::string part;
+	while (std::getline(ss, part, ',')) {
+		cell.push_back(std::stoull(part));
+	}
+	return cell;
+}
+
+// family/from-to,from-to,.../multiplier,multiplier e.g. "xm2x/9-20,9-20,9-19/2471660141"
+inline std::string to_string(const grid_space& space) {
+	std::string ranges;
+	for (const auto& r : space.shift_ranges) {
+		ranges += (ranges.empty() ? "" : ",") + std::to_string(r.first) + "-" + std::to_string(r.second);
+	}
+	return space.family + "/" + ranges + "/" + to_string(space.multipliers);
+}
+
+// inverse of to_string
+inline std::optional<grid_space> parse_grid_space(const std::string& spec) {
+	const auto first = spec.find('/');
+	if (first == std::string::npos) {
+		return {};
+	}
+	const auto second = spec.find('/', first + 1);
+	if (second == std::string::npos) {
+		return {};
+	}
+	grid_space space;
+	space.family = spec.substr(0, first);
+	space.shift_ranges.clear();
+	std::stringstream ranges(spec.substr(first + 1, second - first - 1));
+	std::string range;
+	while (std::getline(ranges, range, ',')) {
+		const auto dash = range.find('-');
+		const auto from = std::stoull(range.substr(0, dash));
+		space.shift_ranges.emplace_back(from, dash == std::string::npos ? from : std::stoull(range.substr(dash + 1)));
+	}
+	space.multipliers = to_grid_cell(spec.substr(second + 1));
+	if (static_cast<int>(space.shift_ranges.size()) != get_shift_count(space.family) || space.multipliers.empty()) {
+		return {};
+	}
+	return space;
+}
+
+template <typename T>
+mixer<T> create_grid_mixer(const std::string& family, const grid_cell& cell) {
+	std::vector<T> c;
+	for (const auto v : cell) {
+		c.push_back(static_cast<T>(v));
+	}
+	assertion(static_cast<int>(c.size()) == get_shift_count(family) + 1, "grid cell does not match the family");
+	if (family == "xmx") {
+		return create_xmx_mixer<T>(xmx_constants<T>{c[0], c[1], c[2]});
+	}
+	if (family == "xm2x") {
+		return create_xm2x_mixer<T>(xm2x_constants<T>{c[0], c[1], c[2], c[3]});
+	}
+	assertion(family == "xm3x", "unknown mixer family");
+	return create_xm3x_mixer<T>(xm3x_constants<T>{c[0], c[1], c[2], c[3], c[4]});
+}
+
+namespace detail {
+inline bool passes_grid_cell(const test_battery_result& br) {
+	const auto analysis = get_worst_statistic_analysis(br);
+	return !analysis || analysis->pass();
+}
+}
+
+// power of two a single cell reaches on its own, e.g. on a remote worker
+template <typename T>
+int evaluate_grid_cell(const grid_space& space, const grid_cell& cell) {
+	const auto setup = create_mixer_test_setup<T>(create_grid_mixer<T>(space.family, cell)).range(space.start_power_of_two, space.stop_power_of_two);
+	return evaluate_multi_pass<T>([](const test_battery_result& br, bool) { return detail::passes_grid_cell(br); }, setup).power_of_two();
+}
+
+using grid_cell_callback = std::function<void(const grid_cell_result&)>;
+
+// cells evaluated together per thread of the pool, enough to keep it busy while a batch is
+// down to its last cells
+constexpr std::size_t grid_batch_cells_per_thread = 4;
+
+// The cells are evaluated breadth first on one shared pool in batches: the jobs of every cell of
+// a batch at a power of two run together and a cell is pruned at the first power it fails, the
+// setups and jobs of one batch only are held at a time. Cells already in the checkpoint are
+// skipped, finished cells are added to it right away and passed to the callback.
+template <typename T>
+std::vector<grid_cell_result> run_grid_search(const grid_space& space, checkpoint& completed, const grid_cell_callback& callback) {
+	std::vector<grid_cell_result> results;
+	std::vector<grid_cell> cells;
+	for (const auto& cell : get_grid_cells(space)) {
+		if (const auto stored = completed.get(to_string(cell))) {
+			results.push_back({cell, std::stoi(*stored)});
+			continue;
+		}
+		cells.push_back(cell);
+	}
+
+	const auto pool = std::make_shared<job_pool>(default_max_threads());
+	std::map<std::string, grid_cell> pending;
+	const auto on_pass = [&](const test_battery_result& br, bool is_last) {
+		const bool proceed = detail::passes_grid_cell(br);
+		if (!proceed || is_last) {
+			const grid_cell_result r{pending.at(br.test_subject_name), br.power_of_two()};
+			completed.add(br.test_subject_name, std::to_string(r.power_of_two));
+			results.push_back(r);
+			if (callback) {
+				callback(r);
+			}
+		}
+		return proceed;
+	};
+	const auto batch_size = grid_batch_cells_per_thread * pool->size();
+	for (std::size_t from = 0; from < cells.size(); from += batch_size) {
+		std::vector<test_setup<T>> setups;
+		pending.clear();
+		for (std::size_t i = from; i < std::min(cells.size(), from + batch_size); ++i) {
+			const auto key = to_string(cells[i]);
+			auto setup = create_mixer_test_setup<T>(create_grid_mixer<T>(space.family, cells[i])).range(space.start_power_of_two, space.stop_power_of_two);
+			// the subject name identifies the cell in the callback
+			setup.test_subject_name = key;
+			setups.push_back(setup.set_pool(pool));
+			pending[key] = cells[i];
+		}
+		evaluate_breadth_first<T>(on_pass, setups);
+	}
+	return results;
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "util/bitvector.h"
 
 namespace tfr {
@@ -21,16 +23,30 @@ xmx_constants<T> to_xmx_constants(const bit_vector& bits) {
 	return {bits.get<T>(0 * s, s), bits.get<T>(1 * s, s), bits.get<T>(2 * s, m)};
 }
 
+// The constants are only known at run time but stay the same over a block, so the block
+// loop vectorizes. The mixer uses the same kernel for single values.
 template <typename T>
-mixer<T> create_xmx_mixer(const xmx_constants<T>& c) {
-	return {
-		"xmx", [c](T x) {
-			x ^= (x >> c.c1);
-			x *= c.m1;
-			x ^= (x >> c.c2);
-			return x;
+struct xmx_kernel {
+	xmx_constants<T> c;
+
+	T operator()(T x) const {
+		x ^= (x >> c.c1);
+		x *= c.m1;
+		x ^= (x >> c.c2);
+		return x;
+	}
+
+	void operator()(std::span<T> values) const {
+		for (auto& x : values) {
+			x = (*this)(x);
 		}
-	};
+	}
+};
+
+template <typename T>
+mixer<T> create_xmx_mixer(const xmx_constants<T>& c) {
+	const xmx_kernel<T> kernel{c};
+	return {"xmx", kernel, kernel};
 }
 
 template <typename T>
@@ -58,17 +74,29 @@ xm2x_constants<T> to_xm2x_constants(const bit_vector& bits) {
 }
 
 template <typename T>
-mixer<T> create_xm2x_mixer(const xm2x_constants<T>& c) {
-	return mixer<T>{
-		"xm2x", [c](T x) {
-			x ^= (x >> c.c1);
-			x *= c.m1;
-			x ^= (x >> c.c2);
-			x *= c.m1;
-			x ^= (x >> c.c3);
-			return x;
+struct xm2x_kernel {
+	xm2x_constants<T> c;
+
+	T operator()(T x) const {
+		x ^= (x >> c.c1);
+		x *= c.m1;
+		x ^= (x >> c.c2);
+		x *= c.m1;
+		x ^= (x >> c.c3);
+		return x;
+	}
+
+	void operator()(std::span<T> values) const {
+		for (auto& x : values) {
+			x = (*this)(x);
 		}
-	};
+	}
+};
+
+template <typename T>
+mixer<T> create_xm2x_mixer(const xm2x_constants<T>& c) {
+	const xm2x_kernel<T> kernel{c};
+	return {"xm2x", kernel, kernel};
 }
 
 template <typename T>
@@ -96,19 +124,31 @@ xm3x_constants<T> to_xm3x_constants(const bit_vector& bits) {
 }
 
 template <typename T>
-mixer<T> create_xm3x_mixer(const xm3x_constants<T>& c) {
-	return mixer<T>{
-		"xm3x", [c](T x) {
-			x ^= (x >> c.c1);
-			x *= c.m1;
-			x ^= (x >> c.c2);
-			x *= c.m1;
-			x ^= (x >> c.c3);
-			x *= c.m1;
-			x ^= (x >> c.c4);
-			return x;
+struct xm3x_kernel {
+	xm3x_constants<T> c;
+
+	T operator()(T x) const {
+		x ^= (x >> c.c1);
+		x *= c.m1;
+		x ^= (x >> c.c2);
+		x *= c.m1;
+		x ^= (x >> c.c3);
+		x *= c.m1;
+		x ^= (x >> c.c4);
+		return x;
+	}
+
+	void operator()(std::span<T> values) const {
+		for (auto& x : values) {
+			x = (*this)(x);
 		}
-	};
+	}
+};
+
+template <typename T>
+mixer<T> create_xm3x_mixer(const xm3x_constants<T>& c) {
+	const xm3x_kernel<T> kernel{c};
+	return {"xm3x", kernel, kernel};
 }
 
 template <typename T>
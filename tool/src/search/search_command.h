@@ -1,7 +1,10 @@
 #pragma once
 
+#include "genetic_search.h"
 #include "search_configs.h"
+#include "util/fitness_cache.h"
 #include "util/random.h"
+#include "util/remote.h"
 #include "util/sffs.h"
 #include "util/sffsutils.h"
 
@@ -48,7 +51,26 @@ sffs_state start_search(const std::string& name, const sffs_config& config) {
 		std::cout << "Seed fitness: " << config.fitness(*seed) << "\n";
 	}
 	//std::cout << "Trng fitness    : " << sffs_fitness_test(trng, default_max_threads()) << "\n";
-	auto result = run_sffs(config, create_sffs_printer(config.to_arr_str));
+	// the genetic search reports the number of evaluations as k
+	genetic_config genetic;
+	if (config.threads > 0) {
+		genetic.threads = config.threads;
+	}
+	if (get_config().genetic_evaluations > 0) {
+		genetic.evaluations = get_config().genetic_evaluations;
+	}
+	if (get_config().genetic_population > 0) {
+		genetic.population = get_config().genetic_population;
+	}
+	if (get_config().genetic) {
+		std::cout << "Genetic search with " << genetic.evaluations << " evaluations and a population of " << genetic.population << "\n";
+		if (config.staged_fitness) {
+			std::cout << "--racing only applies to SFFS, the genetic search evaluates every candidate in full\n";
+		}
+	}
+	auto result = get_config().genetic
+		? run_genetic_search(config, genetic, create_sffs_printer(config.to_arr_str))
+		: run_sffs(config, create_sffs_printer(config.to_arr_str));
 	std::stringstream ss;
 	ss << to_string(result, config.to_arr_str) << "\n";
 	ss << config.to_string(result.data);
@@ -56,6 +78,30 @@ sffs_state start_search(const std::string& name, const sffs_config& config) {
 	return result;
 }
 
+template <typename T>
+std::string get_fitness_task_name(const std::string& family) {
+	return "fitness_" + family + "_" + std::to_string(bit_sizeof<T>());
+}
+
+template <typename T>
+std::string get_staged_fitness_task_name(const std::string& family) {
+	return "staged_fitness_" + family + "_" + std::to_string(bit_sizeof<T>());
+}
+
+// tasks for remote workers of the search command
+template <typename T>
+remote_tasks create_search_tasks() {
+	remote_tasks tasks;
+	const auto add = [&tasks](const std::string& family, const sffs_config& config, staged_fitness_function staged_fitness) {
+		tasks[get_fitness_task_name<T>(family)] = create_fitness_task(config.fitness);
+		tasks[get_staged_fitness_task_name<T>(family)] = create_staged_fitness_task(std::move(staged_fitness));
+	};
+	add("xmx", get_xmx_config<T>(), get_xmx_staged_fitness<T>());
+	add("xm2x", get_xm2x_config<T>(), get_xm2x_staged_fitness<T>());
+	add("xm3x", get_xm3x_config<T>(), get_xm3x_staged_fitness<T>());
+	return tasks;
+}
+
 template <typename T>
 void search_command() {
 	bit_vector seed;
@@ -66,10 +112,40 @@ void search_command() {
 	seed.add(7, 5);
 
 	auto cfg = get_xm2x_config<T>();
-	//cfg.seed = seed;
-	cfg.seed = find_seed(cfg, 100);
-
-	const auto result = start_search<T>("NAME HERE", cfg);
+	if (get_config().racing) {
+		cfg.staged_fitness = get_xm2x_staged_fitness<T>();
+	}
+	// with --listen every fitness call is handed to a remote worker
+	std::shared_ptr<remote_pool> pool;
+	if (get_config().listen_port != 0) {
+		pool = std::make_shared<remote_pool>(get_config().listen_address, get_config().listen_port, get_config().token);
+		std::cout << "Waiting for " << get_config().workers << " workers on port " << pool->port() << "\n";
+		pool->wait_for_workers(get_config().workers);
+		cfg.fitness = create_remote_fitness(pool, get_fitness_task_name<T>("xm2x"));
+		if (cfg.staged_fitness) {
+			cfg.staged_fitness = create_remote_staged_fitness(pool, get_staged_fitness_task_name<T>("xm2x"));
+		}
+		cfg.threads = static_cast<unsigned int>(get_config().workers);
+	}
+	// scores of another fitness version are not reused
+	const auto cache_name = "fitness_xm2x_" + std::to_string(bit_sizeof<T>()) + "_v" + std::to_string(sffs_fitness_version);
+	const auto cache = std::make_shared<fitness_cache>(std::make_unique<checkpoint>(get_config().checkpoint_file_path(cache_name), get_config().resume));
+	cfg.fitness = create_cached_fitness(cfg.fitness, cache);
+	if (cfg.staged_fitness) {
+		cfg.staged_fitness = create_cached_staged_fitness(cfg.staged_fitness, cache);
+	}
+	sffs_state result;
+	try {
+		//cfg.seed = seed;
+		cfg.seed = find_seed(cfg, 100);
+		result = start_search<T>("NAME HERE", cfg);
+	}
+	catch (const remote_error& e) {
+		// failed candidates are not in the cache, --resume evaluates them again
+		std::cout << "Search stopped: " << e.what() << "\nThe completed candidates are in the fitness cache, continue with --resume\n";
+		return;
+	}
+	std::cout << "Fitness cache: " << cache->size() << " candidates, " << cache->hits() << " hits, " << cache->misses() << " misses\n";
 
 	const auto mixer = create_xm2x_mixer<T>(result.data);
 	evaluate_multi_pass(create_result_callback(false), create_mixer_test_setup<T>(mixer));
@@ -6,6 +6,14 @@
 
 namespace tfr {
 
+template <typename T>
+staged_fitness_function get_xmx_staged_fitness() {
+	return [](const bit_vector& bits, int stop_power_of_two) {
+		const auto c = to_xmx_constants<T>(bits);
+		return sffs_fitness_test<T>(create_xmx_mixer<T>(c), stop_power_of_two);
+	};
+}
+
 template <typename T>
 sffs_config get_xmx_config() {
 	auto to_str = [](const bit_vector& bits) {
@@ -24,14 +32,21 @@ sffs_config get_xmx_config() {
 		return ss.str();
 	};
 
-	const auto fitness = [](const bit_vector& bits) {
-		const auto c = to_xmx_constants<T>(bits);
-		return sffs_fitness_test<T>(create_xmx_mixer<T>(c));
+	const auto fitness = [staged_fitness = get_xmx_staged_fitness<T>()](const bit_vector& bits) {
+		return staged_fitness(bits, 25);
 	};
 	constexpr int bits_for_multiplier = bit_sizeof<T>();
 	constexpr int bits_for_shift = shift_sizeof<T>();
 	constexpr int bits = 2 * bits_for_shift + bits_for_multiplier;
-	return {bits, fitness, to_str, to_arr_str};
+	return sffs_config{bits, fitness, to_str, to_arr_str};
+}
+
+template <typename T>
+staged_fitness_function get_xm2x_staged_fitness() {
+	return [](const bit_vector& bits, int stop_power_of_two) {
+		const auto c = to_xm2x_constants<T>(bits);
+		return sffs_fitness_test<T>(create_xm2x_mixer<T>(c), stop_power_of_two);
+	};
 }
 
 template <typename T>
@@ -54,18 +69,25 @@ sffs_config get_xm2x_config() {
 		return ss.str();
 	};
 
-	const auto fitness = [](const bit_vector& bits) {
-		const auto c = to_xm2x_constants<T>(bits);
-		return sffs_fitness_test(create_xm2x_mixer(c));
+	const auto fitness = [staged_fitness = get_xm2x_staged_fitness<T>()](const bit_vector& bits) {
+		return staged_fitness(bits, 25);
 	};
 
 	constexpr int bits_for_multiplier = bit_sizeof<T>();
 	constexpr int bits_for_shift = shift_sizeof<T>();
 	constexpr int bits = 3 * bits_for_shift + bits_for_multiplier;
-	return {bits, fitness, to_str, to_arr_str};
+	return sffs_config{bits, fitness, to_str, to_arr_str};
 }
 
 
+template <typename T>
+staged_fitness_function get_xm3x_staged_fitness() {
+	return [](const bit_vector& bits, int stop_power_of_two) {
+		const auto c = to_xm3x_constants<T>(bits);
+		return sffs_fitness_test<T>(create_xm3x_mixer<T>(c), stop_power_of_two);
+	};
+}
+
 template <typename T>
 sffs_config get_xm3x_config() {
 	auto to_str = [](const bit_vector& bits) {
@@ -88,15 +110,14 @@ sffs_config get_xm3x_config() {
 		return ss.str();
 	};
 
-	const auto fitness = [](const bit_vector& bits) {
-		const auto c = to_xm3x_constants<T>(bits);
-		return sffs_fitness_test(create_xm3x_mixer<T>(c));
+	const auto fitness = [staged_fitness = get_xm3x_staged_fitness<T>()](const bit_vector& bits) {
+		return staged_fitness(bits, 25);
 	};
 
 	constexpr int bits_for_multiplier = bit_sizeof<T>();
 	constexpr int bits_for_shift = shift_sizeof<T>();
 	constexpr int bits = 4 * bits_for_shift + bits_for_multiplier;
-	return {bits, fitness, to_str, to_arr_str};
+	return sffs_config{bits, fitness, to_str, to_arr_str};
 }
 
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/fileutil.h"
+
+namespace tfr {
+
+// Remembers completed work items (key, value) in a file as soon as they complete,
+// so that an interrupted command can be resumed where it left off.
+class checkpoint {
+public:
+	checkpoint(std::string path, bool resume) : _path(std::move(path)) {
+		if (resume) {
+			load();
+		}
+		else {
+			write(_path, "");
+		}
+	}
+
+	bool contains(const std::string& key) const {
+		std::lock_guard lg(_mutex);
+		return _index.contains(key);
+	}
+
+	std::optional<std::string> get(const std::string& key) const {
+		std::lock_guard lg(_mutex);
+		const auto it = _index.find(key);
+		if (it == _index.end()) {
+			return {};
+		}
+		return _entries[it->second].second;
+	}
+
+	void add(const std::string& key, const std::string& value) {
+		assertion(key.find('\t') == std::string::npos && key.find('\n') == std::string::npos, "invalid checkpoint key");
+		assertion(value.find('\n') == std::string::npos, "invalid checkpoint value");
+		std::lock_guard lg(_mutex);
+		_index[key] = _entries.size();
+		_entries.emplace_back(key, value);
+		write_append(_path, key + "\t" + value + "\n");
+	}
+
+	// completed entries in the order they were completed
+	std::vector<std::pair<std::string, std::string>> entries() const {
+		std::lock_guard lg(_mutex);
+		return _entries;
+	}
+
+	std::size_t size() const {
+		std::lock_guard lg(_mutex);
+		return _entries.size();
+	}
+
+private:
+	void load() {
+		std::ifstream file(_path, std::ifstream::binary);
+		std::string line;
+		// end of the last complete line
+		std::uintmax_t complete = 0;
+		while (std::getline(file, line)) {
+			if (file.eof()) {
+				// partially written line from an interrupted run
+				break;
+			}
+			complete += line.size() + 1;
+			// read as binary to count bytes, lines end with \r\n on windows
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			const auto tab = line.find('\t');
+			if (tab == std::string::npos) {
+				continue;
+			}
+			const auto key = line.substr(0, tab);
+			_index[key] = _entries.size();
+			_entries.emplace_back(key, line.substr(tab + 1));
+		}
+		file.close();
+		// new entries are appended, only a partial last line is cut off
+		std::error_code ec;
+		if (std::filesystem::exists(_path, ec) && std::filesystem::file_size(_path, ec) != complete) {
+			std::filesystem::resize_file(_path, complete, ec);
+		}
+	}
+
+	std::string _path;
+	mutable std::mutex _mutex;
+	std::map<std::string, std::size_t> _index;
+	std::vector<std::pair<std::string, std::string>> _entries;
+};
+
+}
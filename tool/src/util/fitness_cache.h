@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+
+#include "checkpoint.h"
+#include "sffs_types.h"
+
+namespace tfr {
+
+// Thread safe fitness scores by candidate bits and the power of two the candidate was tested
+// to. SFFS moves back and forth over the same candidates and racing tests them again at every
+// power, every one of them is only evaluated once. With a checkpoint the scores are also
+// written as they complete and read back on --resume, the checkpoint name has to identify
+// the fitness function.
+class fitness_cache {
+public:
+	// the power of two of full fitness scores
+	static constexpr int full_power = 0;
+
+	fitness_cache() = default;
+
+	explicit fitness_cache(std::unique_ptr<checkpoint> stored) : _stored(std::move(stored)) {
+		for (const auto& e : _stored->entries()) {
+			// lines that do not parse, e.g. from another version, are evaluated again
+			if (const auto key = parse_key(e.first)) {
+				double score{};
+				const auto* end = e.second.data() + e.second.size();
+				const auto r = std::from_chars(e.second.data(), end, score);
+				if (r.ec == std::errc() && r.ptr == end) {
+					_scores[*key] = score;
+				}
+			}
+		}
+	}
+
+	std::optional<double> get(const bit_vector& bits, int power_of_two = full_power) const {
+		std::shared_lock lock(_mutex);
+		const auto it = _scores.find({bits, power_of_two});
+		if (it == _scores.end()) {
+			++_misses;
+			return {};
+		}
+		++_hits;
+		return it->second;
+	}
+
+	void add(const bit_vector& bits, double score, int power_of_two = full_power) {
+		std::unique_lock lock(_mutex);
+		if (!_scores.try_emplace({bits, power_of_two}, score).second) {
+			return;
+		}
+		if (_stored) {
+			std::ostringstream oss;
+			oss << std::setprecision(17) << score;
+			_stored->add(to_key(bits, power_of_two), oss.str());
+		}
+	}
+
+	std::size_t size() const {
+		std::shared_lock lock(_mutex);
+		return _scores.size();
+	}
+
+	uint64_t hits() const {
+		return _hits;
+	}
+
+	uint64_t misses() const {
+		return _misses;
+	}
+
+private:
+	using key = std::pair<bit_vector, int>;
+
+	// the bits, followed by @power for staged scores
+	static std::string to_key(const bit_vector& bits, int power_of_two) {
+		return power_of_two == full_power ? to_string(bits) : to_string(bits) + "@" + std::to_string(power_of_two);
+	}
+
+	static std::optional<key> parse_key(const std::string& text) {
+		const auto at = text.find('@');
+		const auto bits = text.substr(0, at);
+		if (bits.find_first_not_of("01") != std::string::npos) {
+			return {};
+		}
+		int power_of_two = full_power;
+		if (at != std::string::npos) {
+			const auto* end = text.data() + text.size();
+			const auto r = std::from_chars(text.data() + at + 1, end, power_of_two);
+			if (r.ec != std::errc() || r.ptr != end || power_of_two == full_power) {
+				return {};
+			}
+		}
+		return key{to_bit_vector(bits), power_of_two};
+	}
+
+	mutable std::shared_mutex _mutex;
+	std::map<key, double> _scores;
+	std::unique_ptr<checkpoint> _stored;
+	mutable std::atomic<uint64_t> _hits{};
+	mutable std::atomic<uint64_t> _misses{};
+};
+
+// candidates missing in the cache are evaluated outside of its lock
+inline fitness_function create_cached_fitness(fitness_function fitness, std::shared_ptr<fitness_cache> cache) {
+	return [fitness = std::move(fitness), cache = std::move(cache)](const bit_vector& bits) {
+		if (const auto score = cache->get(bits)) {
+			return *score;
+		}
+		const auto score = fitness(bits);
+		cache->add(bits, score);
+		return score;
+	};
+}
+
+inline staged_fitness_function create_cached_staged_fitness(staged_fitness_function fitness, std::shared_ptr<fitness_cache> cache) {
+	return [fitness = std::move(fitness), cache = std::move(cache)](const bit_vector& bits, int stop_power_of_two) {
+		if (const auto score = cache->get(bits, stop_power_of_two)) {
+			return *score;
+		}
+		const auto score = fitness(bits, stop_power_of_two);
+		cache->add(bits, score, stop_power_of_two);
+		return score;
+	};
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "format_result.h"
+
+namespace tfr {
+
+// Job timings and hardware counters of a whole run, per test and per subject.
+class job_profile {
+public:
+	void add(const test_battery_result& br) {
+		std::lock_guard lg(_mutex);
+		for (const auto& t : br.job_timings) {
+			_per_test[t.type].add(t);
+			_per_subject[br.test_subject_name].add(t);
+		}
+	}
+
+	void print() const {
+		std::lock_guard lg(_mutex);
+		std::vector<std::pair<std::string, job_totals>> per_test;
+		for (const auto& e : _per_test) {
+			per_test.emplace_back(get_test_name(e.first), e.second);
+		}
+		std::cout << "Profile per test\n" << to_string("test", per_test) << "\n";
+		const std::vector<std::pair<std::string, job_totals>> per_subject(_per_subject.begin(), _per_subject.end());
+		std::cout << "Profile per subject\n" << to_string("subject", per_subject) << "\n";
+	}
+
+private:
+	mutable std::mutex _mutex;
+	std::map<test_type, job_totals> _per_test;
+	std::map<std::string, job_totals> _per_subject;
+};
+
+inline job_profile& get_job_profile() {
+	static job_profile profile;
+	return profile;
+}
+
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "sffs_types.h"
+#include "socket.h"
+
+namespace tfr {
+
+// Line protocol between the coordinator and its workers, one task in flight per worker:
+//   worker      -> coordinator: HELLO [<token>]
+//   coordinator -> worker:      TASK <name> <payload>
+//   worker      -> coordinator: RESULT <value> or ERROR <message>
+//   coordinator -> worker:      QUIT
+namespace protocol {
+inline const std::string hello = "HELLO";
+inline const std::string task = "TASK";
+inline const std::string result = "RESULT";
+inline const std::string error = "ERROR";
+inline const std::string quit = "QUIT";
+
+// the text after "<command> " if the line starts with it
+inline std::optional<std::string> get_argument(const std::string& line, const std::string& command) {
+	if (line.compare(0, command.size(), command) != 0) {
+		return {};
+	}
+	if (line.size() == command.size()) {
+		return std::string();
+	}
+	if (line[command.size()] != ' ') {
+		return {};
+	}
+	return line.substr(command.size() + 1);
+}
+
+inline std::string to_string(double d) {
+	std::ostringstream oss;
+	oss << std::setprecision(17) << d;
+	return oss.str();
+}
+
+// all of the text as a number
+template <typename T>
+std::optional<T> parse_number(const std::string& text) {
+	T value{};
+	const auto* end = text.data() + text.size();
+	const auto r = std::from_chars(text.data(), end, value);
+	if (r.ec != std::errc() || r.ptr != end) {
+		return {};
+	}
+	return value;
+}
+
+// seconds a connecting worker has to say hello
+constexpr int hello_timeout_seconds = 10;
+}
+
+// Coordinator side: workers connect at any time and call() hands a task to the next idle one.
+// Callers block until a worker is free, so run as many callers as there are workers. A task
+// of a worker that disconnects is handed to another worker. Workers have to send the token
+// in their hello, which should be set whenever the address is reachable by other machines.
+class remote_pool {
+public:
+	remote_pool(const std::string& address, uint16_t port, std::string token) : _listener(address, port), _token(std::move(token)) {
+		_acceptor = std::thread([this] { accept_workers(); });
+	}
+
+	~remote_pool() {
+		_listener.close();
+		_acceptor.join();
+		// at most the hello timeout
+		for (auto& h : _handshakes) {
+			h.thread.join();
+		}
+		std::lock_guard lg(_mutex);
+		for (auto& w : _idle) {
+			w->send_line(protocol::quit);
+		}
+	}
+
+	remote_pool(const remote_pool&) = delete;
+	remote_pool& operator=(const remote_pool&) = delete;
+
+	// the result of the task, empty if it failed on the worker or no worker is left
+	std::optional<std::string> call(const std::string& name, const std::string& payload) {
+		assertion(name.find(' ') == std::string::npos, "space in a remote task name");
+		while (true) {
+			std::unique_ptr<tcp_connection> worker;
+			{
+				std::unique_lock lock(_mutex);
+				_cv.wait(lock, [this] { return !_idle.empty() || _workers == 0; });
+				if (_idle.empty()) {
+					return {};
+				}
+				worker = std::move(_idle.front());
+				_idle.pop_front();
+			}
+			if (worker->send_line(protocol::task + " " + name + " " + payload)) {
+				if (const auto line = worker->receive_line()) {
+					release(std::move(worker));
+					if (const auto value = protocol::get_argument(*line, protocol::result)) {
+						return *value;
+					}
+					std::cout << "Remote task " << name << " " << payload << " failed: " << *line << "\n";
+					return {};
+				}
+			}
+			// lost the worker, try the next one
+			{
+				std::lock_guard lg(_mutex);
+				--_workers;
+				std::cout << "Lost a worker, " << _workers << " left\n";
+			}
+			// wakes up the callers waiting for a worker when it was the last one
+			_cv.notify_all();
+		}
+	}
+
+	void wait_for_workers(std::size_t count) {
+		std::unique_lock lock(_mutex);
+		_cv.wait(lock, [this, count] { return _workers >= count; });
+	}
+
+	std::size_t workers() const {
+		std::lock_guard lg(_mutex);
+		return _workers;
+	}
+
+	uint16_t port() const {
+		return _listener.port();
+	}
+
+private:
+	// a connection being checked for its hello on its own thread
+	struct handshake {
+		std::thread thread;
+		std::shared_ptr<std::atomic<bool>> done;
+	};
+
+	// every connection says hello on its own thread, so one that does not keeps no other
+	// worker waiting
+	void accept_workers() {
+		while (auto worker = _listener.accept()) {
+			std::erase_if(_handshakes, [](handshake& h) {
+				if (!*h.done) {
+					return false;
+				}
+				h.thread.join();
+				return true;
+			});
+			auto done = std::make_shared<std::atomic<bool>>(false);
+			std::thread thread([this, worker = std::move(worker), done]() mutable {
+				check_hello(std::move(worker));
+				*done = true;
+			});
+			_handshakes.push_back({std::move(thread), std::move(done)});
+		}
+	}
+
+	// a connection that does not say hello with the token in time is dropped
+	void check_hello(std::unique_ptr<tcp_connection> worker) {
+		worker->set_receive_timeout(protocol::hello_timeout_seconds);
+		const auto hello = worker->receive_line();
+		const auto token = hello ? protocol::get_argument(*hello, protocol::hello) : std::nullopt;
+		if (!token || *token != _token) {
+			return;
+		}
+		worker->set_receive_timeout(0);
+		{
+			std::lock_guard lg(_mutex);
+			++_workers;
+		}
+		release(std::move(worker));
+	}
+
+	void release(std::unique_ptr<tcp_connection> worker) {
+		{
+			std::lock_guard lg(_mutex);
+			_idle.push_back(std::move(worker));
+		}
+		_cv.notify_all();
+	}
+
+	tcp_listener _listener;
+	std::string _token;
+	std::thread _acceptor;
+	// only used by the acceptor thread until it is joined
+	std::vector<handshake> _handshakes;
+	mutable std::mutex _mutex;
+	std::condition_variable _cv;
+	std::deque<std::unique_ptr<tcp_connection>> _idle;
+	std::size_t _workers{};
+};
+
+using remote_task = std::function<std::string(const std::string& payload)>;
+using remote_tasks = std::map<std::string, remote_task>;
+
+// Worker side: connects to the coordinator and runs tasks until it is told to quit or the
+// connection is closed. A task that throws is reported as an error. Returns false if it could
+// not connect.
+inline bool run_remote_worker(const std::string& host, uint16_t port, const std::string& token, const remote_tasks& tasks) {
+	const auto coordinator = tcp_connect(host, port);
+	if (!coordinator || !coordinator->send_line(token.empty() ? protocol::hello : protocol::hello + " " + token)) {
+		return false;
+	}
+	while (const auto line = coordinator->receive_line()) {
+		if (*line == protocol::quit) {
+			break;
+		}
+		const auto argument = protocol::get_argument(*line, protocol::task);
+		const auto space = argument ? argument->find(' ') : std::string::npos;
+		const auto it = space != std::string::npos ? tasks.find(argument->substr(0, space)) : tasks.end();
+		std::string response = protocol::error + " unknown task";
+		if (it != tasks.end()) {
+			try {
+				response = protocol::result + " " + it->second(argument->substr(space + 1));
+			}
+			catch (const std::exception& e) {
+				std::string message = e.what();
+				std::replace(message.begin(), message.end(), '\n', ' ');
+				response = protocol::error + " " + message;
+			}
+		}
+		if (!coordinator->send_line(response)) {
+			break;
+		}
+	}
+	return true;
+}
+
+// a remote fitness that failed on the worker or found no worker left
+class remote_error : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+// throws remote_error instead of making up a score, which the fitness cache would keep
+inline double to_remote_fitness(remote_pool& pool, const std::string& name, const std::string& payload) {
+	const auto result = pool.call(name, payload);
+	if (const auto score = result ? protocol::parse_number<double>(*result) : std::nullopt) {
+		return *score;
+	}
+	if (pool.workers() == 0) {
+		throw remote_error("no workers left for " + name);
+	}
+	throw remote_error("remote task " + name + " " + payload + " failed");
+}
+}
+
+// fitness evaluated by a worker, the payload is the bits as 0 and 1 characters, throws
+// remote_error if it fails
+inline fitness_function create_remote_fitness(std::shared_ptr<remote_pool> pool, const std::string& name) {
+	return [pool = std::move(pool), name](const bit_vector& bits) {
+		return detail::to_remote_fitness(*pool, name, to_string(bits));
+	};
+}
+
+inline staged_fitness_function create_remote_staged_fitness(std::shared_ptr<remote_pool> pool, const std::string& name) {
+	return [pool = std::move(pool), name](const bit_vector& bits, int stop_power_of_two) {
+		return detail::to_remote_fitness(*pool, name, to_string(bits) + " " + std::to_string(stop_power_of_two));
+	};
+}
+
+inline remote_task create_fitness_task(fitness_function fitness) {
+	return [fitness = std::move(fitness)](const std::string& payload) {
+		return protocol::to_string(fitness(to_bit_vector(payload)));
+	};
+}
+
+inline remote_task create_staged_fitness_task(staged_fitness_function fitness) {
+	return [fitness = std::move(fitness)](const std::string& payload) {
+		const auto space = payload.find(' ');
+		const auto stop_power_of_two = space != std::string::npos ? protocol::parse_number<int>(payload.substr(space + 1)) : std::nullopt;
+		if (!stop_power_of_two) {
+			throw std::invalid_argument("invalid staged fitness payload " + payload);
+		}
+		return protocol::to_string(fitness(to_bit_vector(payload.substr(0, space)), *stop_power_of_two));
+	};
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 
 #include "sffs_types.h"
@@ -14,31 +16,69 @@ struct sffs_state {
 
 using sffs_callback = std::function<void(int k, const sffs_state& new_state, const sffs_state& old_state)>;
 
-inline sffs_state get_state(const sffs_config& config, const sffs_state& current_state, bool is_forward) {
-	const auto& current_data = current_state.data;
+namespace detail {
+inline std::vector<sffs_state> evaluate_candidates(const sffs_config& config, const std::vector<bit_vector>& candidates, const fitness_function& fitness) {
 	jobs<sffs_state> sffs_jobs;
-	for (int i = 0; i < config.bits; ++i) {
-		if (current_data.get_bit(i) == is_forward) continue;
-		auto test = current_data;
-		test.set_bit(i, is_forward);
-		sffs_jobs.emplace_back([test, &config]() {
-				const double score = config.fitness(test);
+	for (const auto& candidate : candidates) {
+		sffs_jobs.emplace_back([candidate, &fitness]() {
+				const double score = fitness(candidate);
 				assertion(is_valid(score), "invalid fitness score for sffs");
-				return sffs_state{test, score};
+				return sffs_state{candidate, score};
 			}
 		);
 	}
 
-	sffs_state best;
-	const auto collector = [&best](const sffs_state& result) {
+	std::vector<sffs_state> states;
+	const auto collector = [&states](const sffs_state& result) {
 		static std::mutex m;
 		std::lock_guard lg(m);
-		if (result.score < best.score) {
-			best = result;
-		}
+		states.push_back(result);
 	};
-	run_jobs<sffs_state>(sffs_jobs, collector, default_max_threads());
-	return best;
+	run_jobs<sffs_state>(sffs_jobs, collector, config.threads > 0 ? config.threads : default_max_threads());
+	// jobs complete in any order
+	std::sort(states.begin(), states.end(), [](const sffs_state& a, const sffs_state& b) {
+		return a.score != b.score ? a.score < b.score : a.data < b.data;
+	});
+	return states;
+}
+
+inline std::vector<bit_vector> get_neighbors(const sffs_config& config, const bit_vector& current_data, bool is_forward) {
+	std::vector<bit_vector> neighbors;
+	for (int i = 0; i < config.bits; ++i) {
+		if (current_data.get_bit(i) == is_forward) continue;
+		auto test = current_data;
+		test.set_bit(i, is_forward);
+		neighbors.push_back(test);
+	}
+	return neighbors;
+}
+
+// Successive halving: all candidates are tested at a low power of two, only the best fraction
+// moves on to the next power. The survivors are scored with the full fitness so that scores of
+// different steps stay comparable.
+inline sffs_state race_candidates(const sffs_config& config, std::vector<bit_vector> candidates) {
+	for (int power = config.racing_start_power_of_two; candidates.size() > 1 && power < config.racing_stop_power_of_two; ++power) {
+		const auto states = evaluate_candidates(config, candidates, [&config, power](const bit_vector& bits) {
+			return config.staged_fitness(bits, power);
+		});
+		const auto keep = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(static_cast<double>(states.size()) * config.racing_keep_fraction)));
+		candidates.clear();
+		for (std::size_t i = 0; i < keep; ++i) {
+			candidates.push_back(states[i].data);
+		}
+	}
+	const auto states = evaluate_candidates(config, candidates, config.fitness);
+	return states.empty() ? sffs_state{} : states.front();
+}
+}
+
+inline sffs_state get_state(const sffs_config& config, const sffs_state& current_state, bool is_forward) {
+	auto candidates = detail::get_neighbors(config, current_state.data, is_forward);
+	if (config.staged_fitness) {
+		return detail::race_candidates(config, std::move(candidates));
+	}
+	const auto states = detail::evaluate_candidates(config, candidates, config.fitness);
+	return states.empty() ? sffs_state{} : states.front();
 }
 
 inline sffs_state get_forward_state(const sffs_config& config, const sffs_state& current_state) {
@@ -5,6 +5,8 @@
 namespace tfr {
 
 using fitness_function = std::function<double(const bit_vector&)>;
+// fitness of a candidate tested up to the given power of two, smaller is better
+using staged_fitness_function = std::function<double(const bit_vector&, int stop_power_of_two)>;
 using bit_vector_to_string = std::function<std::string(const bit_vector&)>;
 
 struct sffs_config {
@@ -15,6 +17,14 @@ struct sffs_config {
 	std::optional<bit_vector> seed;
 	int min = 0;
 	int max = 1000;
+	// concurrent fitness calls, 0 uses all cores
+	unsigned int threads = 0;
+
+	// when set the candidates of a step race through increasing powers of two
+	staged_fitness_function staged_fitness;
+	int racing_start_power_of_two = 14;
+	int racing_stop_power_of_two = 25;
+	double racing_keep_fraction = .5;
 };
 
 }
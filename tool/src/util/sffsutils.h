@@ -4,6 +4,7 @@
 #include <sstream>
 
 #include "sffs.h"
+#include "statistics/avalanche.h"
 
 namespace tfr {
 
@@ -27,15 +28,18 @@ inline auto create_sffs_printer(const bit_vector_to_string& to_arr_str) {
 inline double get_score(const test_battery_result& result, int max_power_of_two) {
 	const double s1 = max_power_of_two - result.power_of_two();
 
-	std::vector<double> all_p_values;
+	p_value_histogram all_p_values(p_value_histogram::default_bin_count);
 	for (const auto& tr : result.results) {
-		append(all_p_values, to_p_values(tr.second));
+		for (const auto& r : tr.second) {
+			all_p_values.add(r.stats.p_value);
+		}
 	}
 
-	const double s2 = kolmogorov_smirnov_stats(all_p_values)->value;
+	const auto ks = kolmogorov_smirnov_stats(all_p_values);
+	const double s2 = ks ? ks->value : 0;
 	double s3 = 0;
 	for (const auto& analysis : get_analysis(result)) {
-		s3 = create_uniform_p_values_analysis(analysis.results).stat.value;
+		s3 = get_uniformity_statistic(result, analysis.test_id).value;
 		break;
 	}
 
@@ -56,9 +60,39 @@ double sffs_fitness_test(const test_setup<T>& ts) {
 	return get_score(r, ts.stop_power_of_two);
 }
 
+// Identifies the scores of sffs_fitness_test in stored fitness caches, change it whenever a
+// change of the tests or the score makes earlier scores incomparable.
+constexpr int sffs_fitness_version = 2;
+
+// Samples of the avalanche proxy, cheap enough that a candidate costs microseconds.
+constexpr uint64_t sffs_proxy_samples = 256;
+constexpr double sffs_proxy_p_value_limit = 1e-6;
+
+// Score of a candidate that fails a SAC test over a few inputs, or nothing if it passes and
+// needs the full battery. Most random candidates have no avalanche at all and are rejected
+// here. The score is worse than any battery result, which is at most
+// stop_power_of_two - 10 + 2, and the bias keeps ordering the rejected candidates.
+template <typename T>
+std::optional<double> sffs_proxy_rejection(const mixer<T>& mixer, int stop_power_of_two) {
+	const auto counts = avalanche_generate_sac<T>(sffs_proxy_samples, create_counter_stream<T>(0x9e3779b97f4a7c15ull), mixer);
+	const auto stats = avalanche_sac_stats<T>(sffs_proxy_samples, counts);
+	if (stats && stats->p_value >= sffs_proxy_p_value_limit) {
+		return {};
+	}
+	return stop_power_of_two + 1 + avalanche_sac_bias(counts);
+}
+
+template <typename T>
+double sffs_fitness_test(const mixer<T>& mixer, int stop_power_of_two) {
+	if (const auto rejected = sffs_proxy_rejection<T>(mixer, stop_power_of_two)) {
+		return *rejected;
+	}
+	return sffs_fitness_test<T>(create_mixer_test_setup<T>(mixer).range(10, stop_power_of_two));
+}
+
 template <typename T>
 double sffs_fitness_test(const mixer<T>& mixer) {
-	return sffs_fitness_test<T>(create_mixer_test_setup<T>(mixer).range(10, 25));
+	return sffs_fitness_test<T>(mixer, 25);
 }
 
 template <typename T>
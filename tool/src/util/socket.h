@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "util/assertion.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace tfr {
+
+// Blocking TCP connection exchanging newline terminated text lines. Only implemented with
+// POSIX sockets, on Windows every connection fails.
+class tcp_connection {
+public:
+	explicit tcp_connection(int fd) : _fd(fd) {
+	}
+
+	~tcp_connection() {
+		close();
+	}
+
+	tcp_connection(const tcp_connection&) = delete;
+	tcp_connection& operator=(const tcp_connection&) = delete;
+
+	bool send_line(const std::string& line) {
+		assertion(line.find('\n') == std::string::npos, "newline in a protocol line");
+#ifndef _WIN32
+		const auto data = line + "\n";
+		std::size_t sent = 0;
+		while (sent < data.size()) {
+			const auto r = ::send(_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (r <= 0) {
+				return false;
+			}
+			sent += static_cast<std::size_t>(r);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// empty when the connection was closed
+	std::optional<std::string> receive_line() {
+#ifndef _WIN32
+		while (true) {
+			const auto newline = _buffer.find('\n');
+			if (newline != std::string::npos) {
+				auto line = _buffer.substr(0, newline);
+				_buffer.erase(0, newline + 1);
+				return line;
+			}
+			char chunk[4096];
+			const auto r = ::recv(_fd, chunk, sizeof(chunk), 0);
+			if (r <= 0) {
+				return {};
+			}
+			_buffer.append(chunk, static_cast<std::size_t>(r));
+		}
+#else
+		return {};
+#endif
+	}
+
+	// receive_line gives up after the timeout, 0 waits forever
+	void set_receive_timeout(int seconds) {
+#ifndef _WIN32
+		timeval timeout{};
+		timeout.tv_sec = seconds;
+		setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+	}
+
+	void close() {
+#ifndef _WIN32
+		if (_fd >= 0) {
+			::shutdown(_fd, SHUT_RDWR);
+			::close(_fd);
+		}
+#endif
+		_fd = -1;
+	}
+
+private:
+	int _fd = -1;
+	std::string _buffer;
+};
+
+inline std::unique_ptr<tcp_connection> tcp_connect(const std::string& host, uint16_t port) {
+#ifndef _WIN32
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+		return {};
+	}
+	std::unique_ptr<tcp_connection> connection;
+	for (auto* a = addresses; a != nullptr && !connection; a = a->ai_next) {
+		const int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if (fd < 0) {
+			continue;
+		}
+		if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+			int no_delay = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+			connection = std::make_unique<tcp_connection>(fd);
+		}
+		else {
+			::close(fd);
+		}
+	}
+	freeaddrinfo(addresses);
+	return connection;
+#else
+	return {};
+#endif
+}
+
+inline bool is_loopback_address(const std::string& address) {
+	return address == "localhost" || address.compare(0, 4, "127.") == 0;
+}
+
+// Accepts connections on an IPv4 address such as 127.0.0.1 or 0.0.0.0 for all interfaces,
+// port 0 picks a free port.
+class tcp_listener {
+public:
+	tcp_listener(const std::string& bind_address, uint16_t port) {
+#ifndef _WIN32
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		const auto numeric = bind_address == "localhost" ? std::string("127.0.0.1") : bind_address;
+		if (inet_pton(AF_INET, numeric.c_str(), &address.sin_addr) != 1) {
+			throw std::runtime_error("invalid listen address " + bind_address);
+		}
+		_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (_fd < 0) {
+			throw std::runtime_error("could not create a socket");
+		}
+		int reuse = 1;
+		setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		if (::bind(_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(_fd, 64) != 0) {
+			close();
+			throw std::runtime_error("could not listen on " + bind_address + ":" + std::to_string(port));
+		}
+		socklen_t length = sizeof(address);
+		getsockname(_fd, reinterpret_cast<sockaddr*>(&address), &length);
+		_port = ntohs(address.sin_port);
+#else
+		throw std::runtime_error("sockets are only supported on POSIX systems");
+#endif
+	}
+
+	~tcp_listener() {
+		close();
+	}
+
+	tcp_listener(const tcp_listener&) = delete;
+	tcp_listener& operator=(const tcp_listener&) = delete;
+
+	// blocks, empty once the listener is closed
+	std::unique_ptr<tcp_connection> accept() {
+#ifndef _WIN32
+		const int fd = ::accept(_fd, nullptr, nullptr);
+		if (fd < 0) {
+			return {};
+		}
+		int no_delay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+		return std::make_unique<tcp_connection>(fd);
+#else
+		return {};
+#endif
+	}
+
+	// also wakes up a blocked accept
+	void close() {
+#ifndef _WIN32
+		const int fd = _fd.exchange(-1);
+		if (fd >= 0) {
+			::shutdown(fd, SHUT_RDWR);
+			::close(fd);
+		}
+#endif
+	}
+
+	uint16_t port() const {
+		return _port;
+	}
+
+private:
+	std::atomic<int> _fd = -1;
+	uint16_t _port{};
+};
+
+}
@@ -0,0 +1,53 @@
+#include <cost_model.h>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+TEST(cost_model, calibrate) {
+	cost_model model;
+	// t = 3 * n^0.5
+	model.calibrate(test_type::gap, 32, 1 << 10, 3 * 32, 1 << 20, 3 * 1024);
+	const auto c = model.get(test_type::gap, 32);
+	EXPECT_NEAR(c.exponent, .5, 1e-9);
+	EXPECT_NEAR(c.ns_per_element, 3, 1e-9);
+	EXPECT_NEAR(model.predict_nanoseconds(test_type::gap, 32, 1 << 16), 3 * 256, 1e-6);
+	// other word sizes keep the defaults
+	EXPECT_EQ(model.get(test_type::gap, 64).samples, 0);
+}
+
+TEST(cost_model, record) {
+	cost_model model;
+	model.set(test_type::mean, 8, {1, 1, 0});
+	model.record(test_type::mean, 8, 100, 500);
+	EXPECT_NEAR(model.get(test_type::mean, 8).ns_per_element, 5, 1e-9);
+	model.record(test_type::mean, 8, 100, 300);
+	EXPECT_NEAR(model.get(test_type::mean, 8).ns_per_element, 4, 1e-9);
+	EXPECT_EQ(model.get(test_type::mean, 8).samples, 2);
+}
+
+TEST(cost_model, save_load) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-cost-model.tsv").string();
+	cost_model model;
+	model.calibrate(test_type::bic, 16, 1 << 10, 100, 1 << 12, 300);
+	ASSERT_TRUE(model.save(path));
+
+	cost_model loaded;
+	ASSERT_TRUE(loaded.load(path));
+	const auto expected = model.get(test_type::bic, 16);
+	const auto actual = loaded.get(test_type::bic, 16);
+	EXPECT_DOUBLE_EQ(actual.ns_per_element, expected.ns_per_element);
+	EXPECT_DOUBLE_EQ(actual.exponent, expected.exponent);
+	EXPECT_EQ(actual.samples, expected.samples);
+	std::filesystem::remove(path);
+}
+
+TEST(cost_model, predict_makespan) {
+	EXPECT_DOUBLE_EQ(predict_makespan({}, 4), 0);
+	EXPECT_DOUBLE_EQ(predict_makespan({5, 3, 3, 2, 2, 1}, 1), 16);
+	// longest first: {5, 2, 1} and {3, 3, 2}
+	EXPECT_DOUBLE_EQ(predict_makespan({5, 3, 3, 2, 2, 1}, 2), 8);
+	EXPECT_DOUBLE_EQ(predict_makespan({7, 1, 1}, 8), 7);
+}
+}
@@ -0,0 +1,102 @@
+#include <evaluate.h>
+#include <util/statistic_analysis.h>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+namespace {
+test_setup<uint32_t> create_evaluate_test_setup(const mixer<uint32_t>& mix) {
+	return test_setup<uint32_t>{
+		mix.name,
+		{create_counter_stream<uint32_t>(1), create_counter_stream<uint32_t>(3)},
+		{test_type::mean, test_type::uniform, test_type::runs},
+		mix
+	}.range(10, 12);
+}
+
+bool pass_callback(const test_battery_result& br, bool) {
+	if (const auto analysis = get_worst_statistic_analysis(br)) {
+		return analysis->pass();
+	}
+	return true;
+}
+}
+
+TEST(evaluate, breadth_first_same_as_multi_pass) {
+	const auto good = create_evaluate_test_setup(get_test_mixer<uint32_t>());
+	const auto bad = create_evaluate_test_setup({"identity", [](uint32_t x) { return x; }});
+
+	std::map<std::string, std::vector<int>> powers;
+	const auto callback = [&powers](const test_battery_result& br, bool is_last) {
+		powers[br.test_subject_name].push_back(br.power_of_two());
+		return pass_callback(br, is_last);
+	};
+	const auto results = evaluate_breadth_first<uint32_t>(callback, {good, bad});
+	ASSERT_EQ(results.size(), 2);
+	EXPECT_EQ(powers[good.test_subject_name], (std::vector{10, 11, 12}));
+	EXPECT_EQ(powers[bad.test_subject_name], (std::vector{10}));
+
+	for (const auto& setup : {good, bad}) {
+		const auto expected = evaluate_multi_pass<uint32_t>(pass_callback, setup);
+		const auto& actual = setup.test_subject_name == good.test_subject_name ? results[0] : results[1];
+		EXPECT_EQ(actual.n, expected.n);
+		ASSERT_EQ(actual.results.size(), expected.results.size());
+		for (const auto& e : expected.results) {
+			EXPECT_EQ(actual[e.first].size(), e.second.size());
+		}
+		EXPECT_EQ(get_worst_statistic_analysis(actual)->stat.p_value, get_worst_statistic_analysis(expected)->stat.p_value);
+	}
+}
+
+TEST(evaluate, breadth_first_different_ranges) {
+	auto a = create_evaluate_test_setup(get_test_mixer<uint32_t>()).range(11, 12);
+	auto b = create_evaluate_test_setup(get_test_mixer<uint32_t>()).range(10, 10);
+	a.test_subject_name = "a";
+	b.test_subject_name = "b";
+	std::vector<std::string> calls;
+	const auto callback = [&calls](const test_battery_result& br, bool is_last) {
+		calls.push_back(br.test_subject_name + std::to_string(br.power_of_two()) + (is_last ? "!" : ""));
+		return true;
+	};
+	const auto results = evaluate_breadth_first<uint32_t>(callback, {a, b});
+	EXPECT_EQ(calls, (std::vector<std::string>{"b10!", "a11", "a12!"}));
+	EXPECT_EQ(results[0].power_of_two(), 12);
+	EXPECT_EQ(results[1].power_of_two(), 10);
+}
+
+TEST(evaluate, job_timings) {
+	const auto setup = create_evaluate_test_setup(get_test_mixer<uint32_t>());
+	const auto br = evaluate(1024, setup);
+	// one job per test and source
+	ASSERT_EQ(br.job_timings.size(), setup.tests.size() * setup.sources.size());
+	EXPECT_EQ(br.threads, setup.max_threads);
+	for (const auto& t : br.job_timings) {
+		// the elements are only counted when profiling
+		EXPECT_EQ(t.elements, 0);
+		EXPECT_EQ(t.generation_nanoseconds, 0);
+		EXPECT_GT(t.wall_nanoseconds, 0);
+	}
+	EXPECT_GE(br.thread_utilization(), 0);
+	EXPECT_LE(br.thread_utilization(), 1);
+
+	auto profiled = setup;
+	for (const auto& t : evaluate(1024, profiled.set_profile(true)).job_timings) {
+		EXPECT_GE(t.elements, 1024);
+		EXPECT_GT(t.wall_nanoseconds, 0);
+		EXPECT_LE(t.kernel_nanoseconds(), t.wall_nanoseconds);
+	}
+}
+
+TEST(evaluate, profile) {
+	auto setup = create_evaluate_test_setup(get_test_mixer<uint32_t>());
+	for (const auto& t : evaluate(1024, setup).job_timings) {
+		EXPECT_FALSE(t.perf);
+	}
+	for (const auto& t : evaluate(1024, setup.set_profile(true)).job_timings) {
+		EXPECT_EQ(t.perf.has_value(), perf_counters::is_supported());
+	}
+}
+
+}
@@ -0,0 +1,55 @@
+#include <export_result.h>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+
+TEST(export_result, json_lines) {
+	test_battery_result br{"mix", 1024, 2, 32};
+	br.passed_milliseconds = 7;
+	br.add({"s1", "mix", 1024, {test_type::uniform, ""}, statistic(statistic_type::chi2, 1.5, 0.25, 3)});
+	br.add({"s2", "mix", 1024, {test_type::gap, "1/2"}, statistic(statistic_type::chi2, 2, 0.5, 4)});
+
+	const auto lines = to_json_lines(br);
+	EXPECT_EQ(std::count(lines.begin(), lines.end(), '\n'), 2);
+	EXPECT_EQ(lines.substr(0, lines.find('\n')),
+	          R"({"subject":"mix","bits":32,"power_of_two":10,"stream":"s1","test":"uniform","sub_test":"","n":1024,)"
+	          R"("statistic":{"type":"chi2","value":1.5,"p_value":0.25,"df":3},"battery_milliseconds":7,"predicted_battery_milliseconds":0})");
+	EXPECT_NE(lines.find(R"("test":"gap","sub_test":"1/2")"), std::string::npos);
+}
+
+TEST(export_result, json_lines_ordered_by_name) {
+	test_battery_result br{"mix", 1024, 2, 32};
+	// interned before the name that sorts ahead of it
+	br.add({"s1", "mix", 1024, {test_type::uniform, "export_result.order.z"}, statistic(statistic_type::chi2, 1, 0.5, 3)});
+	br.add({"s1", "mix", 1024, {test_type::uniform, "export_result.order.a"}, statistic(statistic_type::chi2, 1, 0.5, 3)});
+	const auto lines = to_json_lines(br);
+	EXPECT_LT(lines.find("export_result.order.a"), lines.find("export_result.order.z"));
+}
+
+TEST(export_result, empty) {
+	EXPECT_EQ(to_json_lines(test_battery_result{}), "");
+	EXPECT_EQ(to_json_timing_lines(test_battery_result{}), "");
+}
+
+TEST(export_result, timing_lines) {
+	test_battery_result br{"mix", 1024, 1, 32};
+	br.passed_milliseconds = 1;
+	br.threads = 2;
+	br.job_timings.push_back({test_type::gap, "s1", 1000000, 900000, 1024, 250000});
+
+	const auto lines = to_json_timing_lines(br);
+	EXPECT_EQ(lines,
+	          R"({"subject":"mix","bits":32,"power_of_two":10,"stream":"s1","test":"gap","wall_nanoseconds":1000000,"cpu_nanoseconds":900000,)"
+	          R"("elements":1024,"generation_nanoseconds":250000,"kernel_nanoseconds":750000,"threads":2,"thread_utilization":0.5})" "\n");
+}
+
+TEST(export_result, timing_lines_perf) {
+	test_battery_result br{"mix", 1024, 1, 32};
+	job_timing t{test_type::gap, "s1", 1000, 1000, 1024, 0};
+	t.perf = perf_sample{100, 200, 3, 4};
+	br.job_timings.push_back(t);
+	EXPECT_NE(to_json_timing_lines(br).find(R"("perf":{"cycles":100,"instructions":200,"cache_misses":3,"branch_misses":4}})"), std::string::npos);
+}
+
+}
@@ -0,0 +1,115 @@
+#include <evaluate.h>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+namespace {
+std::string get_test_cache_dir() {
+	const auto dir = std::filesystem::temp_directory_path() / "tfr-unittest-cache/";
+	std::filesystem::remove_all(dir);
+	return dir.string();
+}
+
+test_setup<uint32_t> create_cache_test_setup(const mixer<uint32_t>& mix) {
+	return test_setup<uint32_t>{
+		"cache-test",
+		{create_counter_stream<uint32_t>(1), create_counter_stream<uint32_t>(3)},
+		{test_type::mean, test_type::uniform},
+		mix
+	}.range(10, 11);
+}
+}
+
+TEST(result_cache, store_load) {
+	const result_cache cache(get_test_cache_dir());
+	EXPECT_FALSE(cache.load("key"));
+
+	test_battery_result br{"mix\"1", 1024, 2, 32};
+	br.passed_milliseconds = 12;
+	br.add({"s1", "mix", 1024, {test_type::uniform, ""}, statistic(statistic_type::chi2, 1.25, 0.123456789012345, 3)});
+	br.add({"s2", "mix", 1024, {test_type::gap, "1/2"}, statistic(statistic_type::z_score, -2, 1e-300, 4)});
+	cache.store("key", br);
+
+	const auto loaded = cache.load("key");
+	ASSERT_TRUE(loaded);
+	EXPECT_EQ(loaded->test_subject_name, br.test_subject_name);
+	EXPECT_EQ(loaded->n, br.n);
+	EXPECT_EQ(loaded->samples, br.samples);
+	EXPECT_EQ(loaded->bits, br.bits);
+	EXPECT_EQ(loaded->passed_milliseconds, br.passed_milliseconds);
+	ASSERT_EQ(loaded->results.size(), 2);
+	const auto& gap = (*loaded)[{test_type::gap, "1/2"}];
+	ASSERT_EQ(gap.size(), 1);
+	EXPECT_EQ(gap[0].stream_name, "s2");
+	EXPECT_EQ(gap[0].stats.type, statistic_type::z_score);
+	EXPECT_EQ(gap[0].stats.p_value, 1e-300);
+	const auto& uniform = (*loaded)[{test_type::uniform, ""}];
+	EXPECT_EQ(uniform[0].stats.p_value, 0.123456789012345);
+}
+
+TEST(result_cache, corrupt_entry) {
+	const result_cache cache(get_test_cache_dir());
+	test_battery_result br{"mix", 1024, 2, 32};
+	br.add({"s1", "mix", 1024, {test_type::uniform, ""}, statistic(statistic_type::chi2, 1.25, 0.5, 3)});
+	cache.store("key", br);
+	ASSERT_TRUE(cache.load("key"));
+
+	std::ifstream in(cache.get_path("key"));
+	const std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+	in.close();
+	const auto overwrite = [&cache](const std::string& text) {
+		std::ofstream out(cache.get_path("key"), std::ios::trunc);
+		out << text;
+	};
+	overwrite(content.substr(0, content.size() - 3));
+	EXPECT_FALSE(cache.load("key"));
+	auto garbled = content;
+	garbled.replace(garbled.find("1024"), 4, "10x4");
+	overwrite(garbled);
+	EXPECT_FALSE(cache.load("key"));
+	overwrite(content.substr(0, content.find("\t1024")));
+	EXPECT_FALSE(cache.load("key"));
+}
+
+TEST(result_cache, separator_in_name) {
+	const result_cache cache(get_test_cache_dir());
+	test_battery_result br{"mix", 1024, 2, 32};
+	br.add({"s1", "mix\t2", 1024, {test_type::uniform, ""}, statistic(statistic_type::chi2, 1.25, 0.5, 3)});
+	cache.store("key", br);
+	EXPECT_FALSE(cache.load("key"));
+	test_battery_result sub{"mix", 1024, 2, 32};
+	sub.add({"s1", "mix", 1024, {test_type::gap, "a\nb"}, statistic(statistic_type::chi2, 1.25, 0.5, 3)});
+	cache.store("key", sub);
+	EXPECT_FALSE(cache.load("key"));
+}
+
+TEST(result_cache, fingerprint) {
+	const mixer<uint32_t> m1{"m", [](uint32_t x) { return x * 3; }};
+	const mixer<uint32_t> m2{"m", [](uint32_t x) { return x * 5; }};
+	const auto a = internal::get_fingerprint(create_cache_test_setup(m1));
+	EXPECT_EQ(a, internal::get_fingerprint(create_cache_test_setup(m1)));
+	EXPECT_NE(a, internal::get_fingerprint(create_cache_test_setup(m2)));
+	EXPECT_NE(a, internal::get_fingerprint(create_cache_test_setup(m1).set_tests({test_type::mean})));
+}
+
+TEST(result_cache, evaluate_multi_pass) {
+	const auto cache = std::make_shared<result_cache>(get_test_cache_dir());
+	auto setup = create_cache_test_setup(get_test_mixer<uint32_t>()).set_cache(cache);
+	const auto callback = [](const test_battery_result&, bool) { return true; };
+
+	const auto first = evaluate_multi_pass(callback, setup);
+	const auto key = internal::get_cache_key(setup.test_subject_name, 32, internal::get_fingerprint(setup), 1ull << 11);
+	ASSERT_TRUE(file_exists(cache->get_path(key)));
+
+	// a cached pass is loaded rather than evaluated again
+	auto modified = first;
+	modified.passed_milliseconds = 123456;
+	cache->store(key, modified);
+	const auto second = evaluate_multi_pass(callback, setup);
+	EXPECT_EQ(second.passed_milliseconds, 123456);
+	EXPECT_EQ(second.results.size(), first.results.size());
+}
+
+}
@@ -57,4 +57,53 @@ TEST(anderson_darling, data) {
 	EXPECT_NEAR(s->value, 0.719128, 1e-4); // matches mma
 	EXPECT_NEAR(s->p_value, 0.54268, 1e-4); // not quite mma (0.542522)
 }
+
+TEST(anderson_darling, histogram_exact_below_limit) {
+	auto s = test_stream();
+	std::vector<double> a;
+	p_value_histogram histogram(p_value_histogram::default_bin_count);
+	while (a.size() < p_value_histogram::default_exact_limit) {
+		a.push_back(rescale_type_to_01(s()));
+		histogram.add(a.back());
+	}
+	ASSERT_TRUE(histogram.exact());
+	EXPECT_TRUE(std::is_sorted(histogram.values().begin(), histogram.values().end()));
+	EXPECT_EQ(histogram.values().size(), a.size());
+	const auto expected = anderson_darling_stats(a);
+	std::sort(a.begin(), a.end());
+	EXPECT_EQ(anderson_darling_stats_sorted(a)->value, expected->value);
+	const auto stat = anderson_darling_stats(histogram);
+	EXPECT_EQ(stat->value, expected->value);
+	EXPECT_EQ(stat->p_value, expected->p_value);
+	EXPECT_EQ(stat->df, expected->df);
+}
+
+TEST(anderson_darling, histogram_binned_within_tolerance) {
+	auto s = test_stream();
+	std::vector<double> a;
+	p_value_histogram histogram(p_value_histogram::default_bin_count);
+	while (a.size() < 100000) {
+		a.push_back(rescale_type_to_01(s()));
+		histogram.add(a.back());
+	}
+	ASSERT_FALSE(histogram.exact());
+	const auto expected = anderson_darling_stats(a);
+	const auto stat = anderson_darling_stats(histogram);
+	// the error grows with the values per bin, about 0.01 for 1000 per bin
+	EXPECT_NEAR(stat->value, expected->value, 0.02);
+	EXPECT_NEAR(stat->p_value, expected->p_value, 0.01);
+	EXPECT_EQ(stat->df, expected->df);
+}
+
+TEST(anderson_darling, histogram_one_value_per_bin) {
+	const std::vector<double> a{.1, .2, .3, .4, .5, .6, .7, .8, .9};
+	auto histogram = p_value_histogram::binned(16);
+	histogram.add_all(a);
+	EXPECT_NEAR(anderson_darling_stats(histogram)->value, anderson_darling_stats(a)->value, 1e-12);
+}
+
+TEST(anderson_darling, histogram_empty) {
+	EXPECT_FALSE(anderson_darling_stats(p_value_histogram(16)));
+}
+
 }
@@ -32,6 +32,15 @@ TEST(avalanche, sac_no_change) {
 	EXPECT_NEAR(r->p_value, 0.7532, 1e-4);
 }
 
+TEST(avalanche, sac_bias) {
+	using T = uint32_t;
+	const mixer<T> identity{"identity", [](T x) { return x; }};
+	EXPECT_DOUBLE_EQ(avalanche_sac_bias(avalanche_generate_sac<T>(100, test_stream<T>(), identity)), 15. / 16);
+	const auto bias = avalanche_sac_bias(avalanche_generate_sac<T>(10000, test_stream<T>(), get_default_mixer<T>()));
+	EXPECT_NEAR(bias, .14, .01);
+	EXPECT_EQ(avalanche_sac_bias(std::vector<uint64_t>(33)), 1.);
+}
+
 TEST(avalanche, bic_no_change) {
 	using T = uint64_t;
 	constexpr auto n = 50;
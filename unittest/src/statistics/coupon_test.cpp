@@ -30,6 +30,17 @@ TEST(coupon, expected_probabilities) {
 	EXPECT_NEAR(ps[15], 0.0141, 1e-4);
 }
 
+TEST(coupon, probability_table) {
+	constexpr auto table = get_coupon_probability_table<5>();
+	const auto& ps = expected_probabilities(5);
+	ASSERT_EQ(table.size(), ps.size());
+	for (std::size_t i = 0; i < table.size(); ++i) {
+		EXPECT_DOUBLE_EQ(table[i], ps[i]);
+	}
+	// memoized
+	EXPECT_EQ(&expected_probabilities(5), &ps);
+}
+
 TEST(coupon, expected_draws) {
 	EXPECT_NEAR(expected_draws_per_coupon(1), 1, 1e-4);
 	EXPECT_NEAR(expected_draws_per_coupon(5), 11.4166, 1e-4); // mma 11.41666...
@@ -204,6 +204,21 @@ TEST(students_t_cdf, basic) {
 	EXPECT_NEAR(student_t_cdf(0.615227, 4), 0.571683, 1e-4); // matches mma TTest (given t-score)
 }
 
+TEST(chi2_distribution_cdf, wilson_hilferty_accuracy) {
+	for (const double df : {chi2_wilson_hilferty_min_df, 2000., 32767., 100000.}) {
+		const double sd = std::sqrt(2 * df);
+		for (double t = -6; t <= 12; t += .25) {
+			const double chi2 = df + t * sd;
+			const double expected = chi2_distribution_gamma_cdf(chi2, df);
+			const double p = chi2_distribution_wilson_hilferty_cdf(chi2, df);
+			EXPECT_NEAR(p, expected, 2e-5);
+			if (expected > 1e-12) {
+				EXPECT_NEAR(p / expected, 1, .05);
+			}
+		}
+	}
+}
+
 TEST(f_distribution_cdf, basic) {
 	EXPECT_NEAR(f_distribution_cdf(0.035082, 4, 4), 0.0033683, 1e-4); // matches mma FTest (given f-score)
 }
@@ -43,4 +43,61 @@ TEST(kolmogorov, small_sample_2) {
 	EXPECT_NEAR(r->p_value, 0.02970, 1e-4); // "far" from mma (0.02)
 }
 
+
+TEST(kolmogorov, histogram_exact_below_limit) {
+	auto s = test_stream();
+	std::vector<double> a;
+	p_value_histogram histogram(p_value_histogram::default_bin_count);
+	while (a.size() < p_value_histogram::default_exact_limit) {
+		a.push_back(rescale_type_to_01(s()));
+		histogram.add(a.back());
+	}
+	ASSERT_TRUE(histogram.exact());
+	EXPECT_TRUE(std::is_sorted(histogram.values().begin(), histogram.values().end()));
+	EXPECT_EQ(histogram.values().size(), a.size());
+	const auto expected = kolmogorov_smirnov_stats(a);
+	std::sort(a.begin(), a.end());
+	EXPECT_EQ(kolmogorov_smirnov_stats_sorted(a)->value, expected->value);
+	const auto stat = kolmogorov_smirnov_stats(histogram);
+	EXPECT_EQ(stat->value, expected->value);
+	EXPECT_EQ(stat->p_value, expected->p_value);
+	EXPECT_EQ(stat->df, expected->df);
+}
+
+TEST(kolmogorov, histogram_binned_within_tolerance) {
+	auto s = test_stream();
+	std::vector<double> a;
+	p_value_histogram histogram(p_value_histogram::default_bin_count);
+	while (a.size() < 100000) {
+		a.push_back(rescale_type_to_01(s()));
+		histogram.add(a.back());
+	}
+	ASSERT_FALSE(histogram.exact());
+	const auto expected = kolmogorov_smirnov_stats(a);
+	const auto stat = kolmogorov_smirnov_stats(histogram);
+	// an upper bound, off by at most the share of the values in the largest bin
+	const double tolerance = 2. / p_value_histogram::default_bin_count;
+	EXPECT_GE(stat->value, expected->value);
+	EXPECT_NEAR(stat->value, expected->value, tolerance);
+	EXPECT_EQ(stat->df, expected->df);
+}
+
+TEST(kolmogorov, histogram_coarse_bins) {
+	auto s = test_stream();
+	std::vector<double> a;
+	auto histogram = p_value_histogram::binned(16);
+	while (a.size() < 1000) {
+		a.push_back(rescale_type_to_01(s()));
+		histogram.add(a.back());
+	}
+	const auto expected = kolmogorov_smirnov_stats(a);
+	const auto stat = kolmogorov_smirnov_stats(histogram);
+	EXPECT_GE(stat->value, expected->value);
+	EXPECT_NEAR(stat->value, expected->value, 1. / 16);
+}
+
+TEST(kolmogorov, histogram_empty) {
+	EXPECT_FALSE(kolmogorov_smirnov_stats(p_value_histogram(16)));
+}
+
 }
@@ -115,4 +115,14 @@ TEST(streams, copy) {
 	EXPECT_EQ(sum, sum2);
 	EXPECT_NEAR(sum, 4.9435, 1e-4);
 }
+
+TEST(streams, copy_moved_from) {
+	auto s = test_stream();
+	const auto moved = std::move(s);
+	const auto copy = s;
+	auto assigned = moved;
+	assigned = s;
+	EXPECT_EQ(copy.name, s.name);
+	EXPECT_EQ(assigned.name, s.name);
+}
 }
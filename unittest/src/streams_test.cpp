@@ -5,5 +5,55 @@
 
 namespace tfr {
 
+namespace {
+mixer<uint32_t> create_block_mixer() {
+	const auto mix = [](uint32_t x) { return (x ^ (x >> 15)) * 0x2c1b3c6du; };
+	return {"block", mix, [mix](std::span<uint32_t> values) {
+		for (auto& x : values) {
+			x = mix(x);
+		}
+	}};
+}
+}
+
+TEST(streams, fill) {
+	auto a = create_counter_stream<uint32_t>(3);
+	auto b = a;
+	std::vector<uint32_t> block(10);
+	a.fill(block);
+	for (const auto v : block) {
+		EXPECT_EQ(v, b());
+	}
+	EXPECT_EQ(a(), b());
+}
+
+TEST(streams, mixer_block) {
+	const auto mix = create_block_mixer();
+	std::vector<uint32_t> values{1, 2, 3, 1000};
+	mix(std::span<uint32_t>(values));
+	EXPECT_EQ(values, (std::vector<uint32_t>{mix(1), mix(2), mix(3), mix(1000)}));
+
+	// without a block kernel the mixer is applied one by one
+	const mixer<uint32_t> single{"single", mix.mix};
+	std::vector<uint32_t> single_values{1, 2, 3, 1000};
+	single(std::span<uint32_t>(single_values));
+	EXPECT_EQ(single_values, values);
+}
+
+TEST(streams, buffered_mixer_stream) {
+	const auto mix = create_block_mixer();
+	auto buffered = create_stream_from_mixer(create_counter_stream<uint32_t>(1), mix);
+	auto single = create_buffered_stream_from_mixer(create_counter_stream<uint32_t>(1), mix, 7);
+	auto source = create_counter_stream<uint32_t>(1);
+	EXPECT_EQ(buffered.name, "block(counter-1)");
+	for (int i = 0; i < 1000; ++i) {
+		const auto expected = mix(source());
+		EXPECT_EQ(buffered(), expected);
+		EXPECT_EQ(single(), expected);
+	}
+	// copies continue independently from the same position
+	auto copy = buffered;
+	EXPECT_EQ(copy(), buffered());
+}
 
 }
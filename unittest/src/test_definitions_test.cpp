@@ -0,0 +1,65 @@
+#include <evaluate.h>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+namespace {
+// restores the global test registry, so a registered test does not leak into other tests
+template <typename T>
+class scoped_test_registry {
+public:
+	~scoped_test_registry() {
+		detail::get_test_name_table() = _names;
+		detail::get_test_registry<T>() = _tests;
+	}
+
+private:
+	detail::test_name_table _names = detail::get_test_name_table();
+	detail::test_registry<T> _tests = detail::get_test_registry<T>();
+};
+}
+
+TEST(test_definitions, lookup) {
+	const auto& tests = get_tests<uint32_t>();
+	EXPECT_EQ(tests.size(), default_test_types.size());
+	for (const auto& test_def : tests) {
+		EXPECT_EQ(&get_test_definition<uint32_t>(test_def.type), &test_def);
+		EXPECT_EQ(get_test_name(test_def.type), test_def.name);
+		EXPECT_EQ(find_test_type(test_def.name), test_def.type);
+	}
+	EXPECT_EQ(get_test_name(test_type::binary_rank), "binary-rank");
+	EXPECT_FALSE(find_test_type("unknown"));
+	// the registry is built once
+	EXPECT_EQ(&get_tests<uint32_t>(), &tests);
+}
+
+TEST(test_definitions, register_test) {
+	const scoped_test_registry<uint16_t> restore;
+	const auto type = next_test_type();
+	register_test<uint16_t>({type, [](uint64_t n, const stream<uint16_t>&) {
+		return main_sub_test(statistic(statistic_type::z_score, 0, .5, static_cast<double>(n)));
+	}, {}, "user-test"});
+	EXPECT_EQ(get_test_name(type), "user-test");
+	EXPECT_EQ(find_test_type("user-test"), type);
+	EXPECT_EQ(get_tests<uint16_t>().back().name, "user-test");
+	EXPECT_NE(next_test_type(), type);
+
+	const test_setup<uint16_t> setup{"user", {create_counter_stream<uint16_t>(1)}, {type}, get_test_mixer<uint16_t>()};
+	const auto br = evaluate(1024, setup);
+	ASSERT_EQ(br.results.size(), 1);
+	EXPECT_EQ(br.results.begin()->first.type, type);
+}
+
+TEST(test_definitions, register_test_restored) {
+	const auto type = next_test_type();
+	{
+		const scoped_test_registry<uint16_t> restore;
+		register_test<uint16_t>({type, {}, {}, "scoped-test"});
+	}
+	EXPECT_EQ(next_test_type(), type);
+	EXPECT_FALSE(find_test_type("scoped-test"));
+	EXPECT_EQ(get_tests<uint16_t>().size(), default_test_types.size());
+}
+}
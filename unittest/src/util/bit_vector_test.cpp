@@ -1,5 +1,7 @@
 #include <util/bitvector.h>
 
+#include <bit>
+
 #include <gtest/gtest.h>
 
 #include "testutil.h"
@@ -61,5 +63,73 @@ TEST(bit_vector, misc) {
 	EXPECT_EQ(b.get(1, 14), 0b11011101001010);
 }
 
+TEST(bit_vector, inter_word) {
+	bit_vector b;
+	b.add(0x123456789abcdefull, 60);
+	b.add(0xabcd, 16);
+	EXPECT_EQ(b.size(), 76);
+	EXPECT_EQ(b.get(0, 60), 0x123456789abcdefull);
+	EXPECT_EQ(b.get(60, 16), 0xabcd);
+	EXPECT_EQ(b.get(56, 12), 0xcd1);
+	EXPECT_EQ(b.count(), std::popcount(0x123456789abcdefull) + std::popcount(0xabcdu));
+
+	b.set(58, 10, 0x3ff);
+	EXPECT_EQ(b.get(58, 10), 0x3ff);
+	EXPECT_EQ(b.get(0, 58), 0x123456789abcdefull & ((1ull << 58) - 1));
+	EXPECT_EQ(b.get(68, 8), 0xab);
+	b.set(58, 10, 0);
+	EXPECT_EQ(b.get(56, 12), 1);
+}
+
+TEST(bit_vector, full_words) {
+	bit_vector b(128);
+	b.set(0, 64, ~0ull);
+	b.set(64, 64, 0x8000000000000001ull);
+	EXPECT_EQ(b.get(0, 64), ~0ull);
+	EXPECT_EQ(b.get(64, 64), 0x8000000000000001ull);
+	EXPECT_EQ(b.get(32, 64), 0x1ffffffffull);
+	EXPECT_EQ(b.get(7, 0), 0);
+	EXPECT_EQ(b.count(), 66);
+}
+
+TEST(bit_vector, past_inline_storage) {
+	bit_vector b;
+	for (int i = 0; i < 5; ++i) {
+		b.add(0xff00ff00ff00ff00ull, 64);
+	}
+	b.add(5, 3);
+	EXPECT_EQ(b.size(), 323);
+	EXPECT_EQ(b.count(), 5 * 32 + 2);
+	for (int i = 0; i < 5; ++i) {
+		EXPECT_EQ(b.get(64 * i, 64), 0xff00ff00ff00ff00ull);
+	}
+	EXPECT_EQ(b.get(250, 20), 0xfc03f);
+	EXPECT_EQ(b.get(320, 3), 5);
+
+	auto c = b;
+	EXPECT_EQ(c, b);
+	c.set_bit(300, !c.get_bit(300));
+	EXPECT_NE(c, b);
+	EXPECT_EQ(to_bit_vector(to_string(b)), b);
+}
+
+TEST(bit_vector, compare) {
+	bit_vector a(10);
+	bit_vector b(10);
+	EXPECT_EQ(a, b);
+	b.set_bit(3, true);
+	EXPECT_NE(a, b);
+	EXPECT_LT(a, b);
+	b.set_bit(3, false);
+	EXPECT_EQ(a, b);
+	EXPECT_NE(a, bit_vector(11));
+}
+
+TEST(bit_vector, string_round_trip) {
+	bit_vector b;
+	b.add(0b10110111010010101, 17);
+	EXPECT_EQ(to_bit_vector(to_string(b)), b);
+	EXPECT_EQ(to_bit_vector(""), bit_vector());
+}
 
 }
@@ -0,0 +1,70 @@
+#include <util/diagnostics.h>
+
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+namespace diagnostics {
+TEST(diagnostics, lag_bins) {
+	EXPECT_EQ(to_lag_bin<uint32_t>(0), 0u);
+	EXPECT_EQ(to_lag_bin<uint32_t>(0x00ffffff), 0u);
+	EXPECT_EQ(to_lag_bin<uint32_t>(0x01000000), 1u);
+	EXPECT_EQ(to_lag_bin<uint32_t>(0xffffffff), lag_size - 1u);
+	EXPECT_EQ(to_lag_bin<uint64_t>(0x8000000000000000ull), lag_size / 2u);
+
+	std::vector<uint64_t> lag(lag_size * lag_size);
+	const std::vector<uint32_t> values{0x01000000, 0x02000000, 0x01000000, 0x02000000};
+	add_lag_pairs<uint32_t>(values, lag);
+	EXPECT_EQ(lag[1 * lag_size + 2], 2u);
+	EXPECT_EQ(lag[2 * lag_size + 1], 1u);
+	EXPECT_EQ(std::accumulate(lag.begin(), lag.end(), uint64_t{}), values.size() - 1);
+}
+
+TEST(diagnostics, density_grey) {
+	EXPECT_EQ(to_density_grey(0, 4), 0);
+	EXPECT_EQ(to_density_grey(4, 4), 128);
+	EXPECT_EQ(to_density_grey(8, 4), 160);
+	EXPECT_EQ(to_density_grey(2, 4), 96);
+	EXPECT_EQ(to_density_grey(1ull << 40, 1), 255);
+	EXPECT_EQ(to_density_grey(1, 1ull << 40), 0);
+}
+
+TEST(diagnostics, bias_color) {
+	EXPECT_EQ(to_bias_color(0), (std::array<unsigned char, 3>{128, 128, 128}));
+	EXPECT_EQ(to_bias_color(8), (std::array<unsigned char, 3>{255, 0, 0}));
+	EXPECT_EQ(to_bias_color(-100), (std::array<unsigned char, 3>{0, 0, 255}));
+	const auto half = to_bias_color(-4);
+	EXPECT_EQ(half[0], half[1]);
+	EXPECT_GT(half[2], 128);
+	EXPECT_LT(half[0], 128);
+}
+
+TEST(diagnostics, bic_parallel_as_serial) {
+	const auto mixer = get_test_mixer<uint32_t>();
+	const uint64_t n = 1000;
+	const auto serial = avalanche_generate_bic<uint32_t>(n, create_counter_stream<uint32_t>(1), mixer);
+	for (const unsigned int threads : {1u, 3u, 8u}) {
+		EXPECT_EQ(generate_bic_parallel<uint32_t>(mixer, n, threads), serial) << threads << " threads";
+	}
+}
+
+TEST(diagnostics, lag_parallel_as_serial) {
+	const auto mixer = get_test_mixer<uint32_t>();
+	// more than one chunk per job
+	const uint64_t n = 300000;
+	std::vector<uint32_t> values(n + 1);
+	std::iota(values.begin(), values.end(), 0u);
+	mixer(std::span<uint32_t>(values));
+	std::vector<uint64_t> serial(lag_size * lag_size);
+	add_lag_pairs<uint32_t>(values, serial);
+	for (const unsigned int threads : {1u, 3u, 8u}) {
+		const auto lag = generate_lag_parallel<uint32_t>(mixer, n, threads);
+		EXPECT_EQ(lag, serial) << threads << " threads";
+		EXPECT_EQ(std::accumulate(lag.begin(), lag.end(), uint64_t{}), n);
+	}
+}
+}
+}
@@ -0,0 +1,106 @@
+#include <util/jobs.h>
+
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+
+TEST(jobs, run_jobs) {
+	jobs<int> js;
+	for (int i = 1; i <= 100; ++i) {
+		js.emplace_back([i] { return i; });
+	}
+	std::atomic_int sum = 0;
+	run_jobs<int>(js, [&sum](int v) { sum += v; }, 4);
+	EXPECT_EQ(sum, 5050);
+}
+
+TEST(jobs, run_jobs_rethrows) {
+	jobs<int> js;
+	for (int i = 1; i <= 100; ++i) {
+		js.emplace_back([i] {
+			if (i == 50) {
+				throw std::runtime_error("job failed");
+			}
+			return i;
+		});
+	}
+	std::atomic_int count = 0;
+	EXPECT_THROW(run_jobs<int>(js, [&count](int) { ++count; }, 4), std::runtime_error);
+	EXPECT_LT(count, 100);
+}
+
+TEST(job_pool, empty) {
+	job_pool pool(2);
+	EXPECT_EQ(pool.size(), 2);
+	pool.run<int>({}, [](int) {});
+}
+
+TEST(job_pool, concurrent_callers) {
+	job_pool pool(3);
+	std::vector<int> sums(8);
+	std::vector<std::thread> callers;
+	for (int c = 0; c < 8; ++c) {
+		callers.emplace_back([&pool, &sums, c] {
+			jobs<int> js;
+			for (int i = 1; i <= 100; ++i) {
+				js.emplace_back([i, c] { return i * (c + 1); });
+			}
+			std::mutex m;
+			pool.run<int>(js, [&sums, &m, c](int v) {
+				std::lock_guard lg(m);
+				sums[c] += v;
+			});
+		});
+	}
+	for (auto& t : callers) {
+		t.join();
+	}
+	for (int c = 0; c < 8; ++c) {
+		EXPECT_EQ(sums[c], 5050 * (c + 1));
+	}
+}
+
+TEST(job_pool, most_expensive_first) {
+	job_pool pool(1);
+	// keeps the worker busy until all jobs are queued
+	std::promise<void> started;
+	std::promise<void> queued;
+	auto blocked = queued.get_future().share();
+	std::vector<int> order;
+	std::thread first([&pool, &started, blocked] {
+		pool.run<int>({[&started, blocked] {
+			started.set_value();
+			blocked.wait();
+			return 0;
+		}}, [](int) {});
+	});
+	started.get_future().wait();
+	std::vector<std::thread> callers;
+	for (int c = 0; c < 2; ++c) {
+		callers.emplace_back([&pool, &order, c] {
+			jobs<int> js;
+			std::vector<double> costs;
+			for (int i = 0; i < 3; ++i) {
+				js.emplace_back([i, c] { return c * 10 + i; });
+				costs.push_back(c * 10 + i);
+			}
+			pool.run<int>(js, [&order](int v) { order.push_back(v); }, costs);
+		});
+	}
+	while (pool.queued() < 6) {
+		std::this_thread::yield();
+	}
+	queued.set_value();
+	for (auto& t : callers) {
+		t.join();
+	}
+	first.join();
+	EXPECT_EQ(order, (std::vector<int>{12, 11, 10, 2, 1, 0}));
+}
+
+}
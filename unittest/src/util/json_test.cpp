@@ -0,0 +1,29 @@
+#include <util/json.h>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+
+TEST(json, escape) {
+	EXPECT_EQ(json_escape(""), "");
+	EXPECT_EQ(json_escape("abc"), "abc");
+	EXPECT_EQ(json_escape("a\"b"), "a\\\"b");
+	EXPECT_EQ(json_escape("a\\b"), "a\\\\b");
+	EXPECT_EQ(json_escape("a\nb\t"), "a\\nb\\t");
+	EXPECT_EQ(json_escape(std::string(1, '\x01')), "\\u0001");
+}
+
+TEST(json, object) {
+	EXPECT_EQ(json_object().to_string(), "{}");
+	EXPECT_EQ(json_object().add("a", 1).to_string(), "{\"a\":1}");
+	EXPECT_EQ(json_object().add("a", "x").add("b", uint64_t{2}).to_string(), "{\"a\":\"x\",\"b\":2}");
+	EXPECT_EQ(json_object().add("a", 0.5).add_bool("b", true).to_string(), "{\"a\":0.5,\"b\":true}");
+	EXPECT_EQ(json_object().add("a", json_object().add("b", 1)).to_string(), "{\"a\":{\"b\":1}}");
+}
+
+TEST(json, non_finite) {
+	EXPECT_EQ(json_object().add("a", std::nan("")).to_string(), "{\"a\":null}");
+	EXPECT_EQ(json_object().add("a", std::numeric_limits<double>::infinity()).add("b", -std::numeric_limits<double>::infinity()).to_string(), "{\"a\":null,\"b\":null}");
+}
+
+}
@@ -40,6 +40,13 @@ TEST(math, stirling_second_kind) {
 	EXPECT_EQ(stirling_second_kind(20, 11), 1900842429486);
 }
 
+TEST(math, stirling_second_kind_constexpr) {
+	static_assert(stirling_second_kind(4, 2) == 7);
+	static_assert(stirling_second_kind(20, 9) == 12011282644725);
+	EXPECT_EQ(stirling_second_kind(3, 4), 0);
+	EXPECT_EQ(stirling_second_kind(64, 64), 1);
+}
+
 TEST(math, stirling_second_kind_limits) {
 	EXPECT_EQ(stirling_second_kind(25, 5), 2436684974110751);
 	EXPECT_EQ(stirling_second_kind(25, 6), 37026417000002430);
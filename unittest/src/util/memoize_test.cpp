@@ -0,0 +1,45 @@
+#include <util/memoize.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+TEST(memoize, computes_once) {
+	int computed = 0;
+	const memoized<int, std::vector<int>> table([&computed](int n) {
+		++computed;
+		return std::vector<int>(n, n);
+	});
+	const auto& a = table(3);
+	EXPECT_EQ(a, (std::vector{3, 3, 3}));
+	EXPECT_EQ(&table(3), &a);
+	EXPECT_EQ(computed, 1);
+	EXPECT_EQ(table(1), (std::vector{1}));
+	EXPECT_EQ(computed, 2);
+	EXPECT_EQ(table.size(), 2);
+}
+
+TEST(memoize, concurrent) {
+	std::atomic<int> computed = 0;
+	const memoized<int, int> table([&computed](int n) {
+		++computed;
+		return n * n;
+	});
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&table] {
+			for (int i = 0; i < 1000; ++i) {
+				EXPECT_EQ(table(i % 10), (i % 10) * (i % 10));
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(table.size(), 10);
+	EXPECT_GE(computed, 10);
+}
+}
@@ -0,0 +1,78 @@
+#include <util/name_table.h>
+
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+TEST(name_table, intern) {
+	name_table table;
+	EXPECT_EQ(table.intern(""), 0);
+	const auto a = table.intern("a");
+	const auto b = table.intern(std::string("b"));
+	EXPECT_NE(a, b);
+	EXPECT_EQ(table.intern("a"), a);
+	EXPECT_EQ(table.name(a), "a");
+	EXPECT_EQ(table.name(b), "b");
+	EXPECT_EQ(table.size(), 3);
+}
+
+TEST(name_table, stable_names) {
+	name_table table;
+	const auto& first = table.name(table.intern("a rather long name that does not fit small strings"));
+	for (int i = 0; i < 1000; ++i) {
+		table.intern(std::to_string(i));
+	}
+	EXPECT_EQ(first, "a rather long name that does not fit small strings");
+	EXPECT_EQ(table.intern(first), 1);
+}
+
+TEST(name_table, concurrent) {
+	name_table table;
+	std::vector<std::vector<name_id>> ids(4);
+	std::vector<std::thread> threads;
+	for (auto& thread_ids : ids) {
+		threads.emplace_back([&table, &thread_ids] {
+			for (int i = 0; i < 1000; ++i) {
+				thread_ids.push_back(table.intern(std::to_string(i % 100)));
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(table.size(), 101);
+	for (const auto& thread_ids : ids) {
+		EXPECT_EQ(thread_ids, ids[0]);
+	}
+}
+
+TEST(interned_name, compare) {
+	const interned_name a = "a";
+	const interned_name b = std::string("b");
+	EXPECT_EQ(a, interned_name("a"));
+	EXPECT_NE(a, b);
+	EXPECT_EQ(a.str(), "a");
+	EXPECT_TRUE(interned_name().empty());
+	EXPECT_TRUE(interned_name("").empty());
+	EXPECT_FALSE(a.empty());
+	EXPECT_EQ(std::set<interned_name>({a, b, a}).size(), 2);
+	EXPECT_EQ(std::unordered_set<interned_name>({a, b, a}).size(), 2);
+}
+
+TEST(interned_name, order_of_ids_and_strings) {
+	// interned before the names that sort ahead of it
+	const interned_name z = "interned_name.order.z";
+	const interned_name a = "interned_name.order.a";
+	EXPECT_LT(z.id(), a.id());
+	EXPECT_LT(z, a);
+	EXPECT_FALSE(a < z);
+	EXPECT_FALSE(a < a);
+	EXPECT_TRUE(a.less_by_name(z));
+	EXPECT_FALSE(z.less_by_name(a));
+	EXPECT_FALSE(a.less_by_name(a));
+}
+}
@@ -0,0 +1,34 @@
+#include <util/perf_counters.h>
+
+#include <gtest/gtest.h>
+
+namespace tfr {
+TEST(perf_counters, sample) {
+	perf_counters counters;
+	EXPECT_EQ(counters.available(), perf_counters::is_supported());
+	counters.start();
+	volatile uint64_t sum = 0;
+	for (uint64_t i = 0; i < 100000; ++i) {
+		sum = sum + i;
+	}
+	const auto sample = counters.stop();
+	// unsupported platforms and restricted kernels degrade to no sample
+	EXPECT_EQ(sample.has_value(), counters.available());
+	if (sample) {
+		EXPECT_GT(sample->instructions, 100000);
+		EXPECT_GT(sample->cycles, 0);
+		EXPECT_GT(sample->instructions_per_cycle(), 0);
+	}
+}
+
+TEST(perf_counters, add) {
+	perf_sample a{1, 2, 3, 4};
+	a += perf_sample{10, 20, 30, 40};
+	EXPECT_EQ(a.cycles, 11);
+	EXPECT_EQ(a.instructions, 22);
+	EXPECT_EQ(a.cache_misses, 33);
+	EXPECT_EQ(a.branch_misses, 44);
+	EXPECT_DOUBLE_EQ(a.instructions_per_cycle(), 2);
+	EXPECT_EQ(perf_sample{}.instructions_per_cycle(), 0);
+}
+}
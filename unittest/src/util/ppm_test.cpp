@@ -0,0 +1,238 @@
+#include <util/ppm.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "testutil.h"
+
+namespace tfr {
+namespace {
+std::vector<unsigned char> read_file(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+uint32_t read_u32(const std::vector<unsigned char>& d, std::size_t i) {
+	return (uint32_t{d[i]} << 24) | (uint32_t{d[i + 1]} << 16) | (uint32_t{d[i + 2]} << 8) | d[i + 3];
+}
+
+std::span<const unsigned char> to_bytes(const std::string& s) {
+	return {reinterpret_cast<const unsigned char*>(s.data()), s.size()};
+}
+
+// inflates the stored and fixed Huffman blocks image_writer writes
+class inflater {
+public:
+	explicit inflater(std::span<const unsigned char> data) : _data(data) {
+	}
+
+	std::vector<unsigned char> inflate() {
+		std::vector<unsigned char> out;
+		bool last = false;
+		while (!last) {
+			last = get_bits(1) == 1;
+			const auto type = get_bits(2);
+			if (type == 0) {
+				_bit = (_bit + 7) / 8 * 8;
+				const auto length = get_bits(16);
+				EXPECT_EQ(length ^ 0xffff, get_bits(16));
+				for (uint32_t i = 0; i < length; ++i) {
+					out.push_back(static_cast<unsigned char>(get_bits(8)));
+				}
+				continue;
+			}
+			EXPECT_EQ(type, 1u);
+			for (int symbol = get_symbol(); symbol != 256; symbol = get_symbol()) {
+				if (symbol < 256) {
+					out.push_back(static_cast<unsigned char>(symbol));
+					continue;
+				}
+				const auto index = symbol - 257;
+				const auto length = detail::length_base[index] + static_cast<int>(get_bits(detail::length_extra_bits[index]));
+				// only distance codes 0-3 have no extra bits
+				const auto distance = static_cast<std::size_t>(get_code(5)) + 1;
+				EXPECT_LE(distance, 4u);
+				EXPECT_LE(distance, out.size());
+				for (int i = 0; i < length; ++i) {
+					out.push_back(out[out.size() - distance]);
+				}
+			}
+		}
+		_bit = (_bit + 7) / 8 * 8;
+		return out;
+	}
+
+	std::size_t byte_offset() const {
+		return _bit / 8;
+	}
+
+private:
+	uint32_t get_bits(int count) {
+		uint32_t v = 0;
+		for (int i = 0; i < count; ++i, ++_bit) {
+			v |= ((_data[_bit / 8] >> (_bit % 8)) & 1u) << i;
+		}
+		return v;
+	}
+
+	uint32_t get_code(int count) {
+		uint32_t v = 0;
+		for (int i = 0; i < count; ++i) {
+			v = (v << 1) | get_bits(1);
+		}
+		return v;
+	}
+
+	int get_symbol() {
+		auto code = get_code(7);
+		if (code < 24) {
+			return 256 + static_cast<int>(code);
+		}
+		code = (code << 1) | get_bits(1);
+		if (code >= 0x30 && code < 0xc0) {
+			return static_cast<int>(code) - 0x30;
+		}
+		if (code >= 0xc0 && code < 0xc8) {
+			return 280 + static_cast<int>(code) - 0xc0;
+		}
+		code = (code << 1) | get_bits(1);
+		return 144 + static_cast<int>(code) - 0x190;
+	}
+
+	std::span<const unsigned char> _data;
+	std::size_t _bit = 0;
+};
+
+// the pixels of a png written by image_writer: checks the chunk crcs, the deflate blocks and the adler32
+std::vector<unsigned char> read_png(const std::vector<unsigned char>& file, std::size_t* idat_size = nullptr) {
+	std::vector<unsigned char> zlib;
+	std::size_t i = 8;
+	while (i < file.size()) {
+		const auto length = read_u32(file, i);
+		const std::string type(file.begin() + i + 4, file.begin() + i + 8);
+		EXPECT_EQ(read_u32(file, i + 8 + length), crc32(std::span(file).subspan(i + 4, length + 4)));
+		if (type == "IDAT") {
+			zlib.insert(zlib.end(), file.begin() + i + 8, file.begin() + i + 8 + length);
+		}
+		i += 12 + length;
+	}
+	if (idat_size) {
+		*idat_size = zlib.size();
+	}
+	EXPECT_EQ(zlib[0], 0x78);
+	inflater in{std::span(zlib).subspan(2)};
+	const auto raw = in.inflate();
+	EXPECT_EQ(read_u32(zlib, 2 + in.byte_offset()), adler32(raw));
+	EXPECT_EQ(zlib.size(), 2 + in.byte_offset() + 4);
+	return raw;
+}
+}
+
+TEST(ppm, checksums) {
+	EXPECT_EQ(crc32(to_bytes("123456789")), 0xcbf43926u);
+	EXPECT_EQ(crc32(to_bytes("IEND")), 0xae426082u);
+	EXPECT_EQ(crc32(to_bytes("6789"), crc32(to_bytes("12345"))), 0xcbf43926u);
+	EXPECT_EQ(adler32(to_bytes("Wikipedia")), 0x11e60398u);
+	const std::vector<unsigned char> ones(100000, 0xff);
+	EXPECT_EQ(adler32(std::span(ones).subspan(50000), adler32(std::span(ones).first(50000))), adler32(ones));
+}
+
+TEST(ppm, pgm_rows) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-image.pgm").string();
+	const auto render = [](int y, std::span<unsigned char> row) {
+		for (std::size_t x = 0; x < row.size(); ++x) {
+			row[x] = static_cast<unsigned char>(y * 10 + x);
+		}
+	};
+	ASSERT_TRUE(render_image(path, 3, 5, 1, render, 4, 2));
+	const auto file = read_file(path);
+	const std::string header = "P5\n3 5\n255\n";
+	ASSERT_EQ(file.size(), header.size() + 15);
+	EXPECT_EQ(std::string(file.begin(), file.begin() + header.size()), header);
+	for (int y = 0; y < 5; ++y) {
+		for (int x = 0; x < 3; ++x) {
+			EXPECT_EQ(file[header.size() + y * 3 + x], y * 10 + x);
+		}
+	}
+	std::filesystem::remove(path);
+}
+
+TEST(ppm, png_rows) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-image.png").string();
+	// rows longer than a stored block
+	constexpr int width = 30000;
+	constexpr int height = 7;
+	const auto render = [](int y, std::span<unsigned char> row) {
+		for (std::size_t x = 0; x < row.size(); ++x) {
+			row[x] = static_cast<unsigned char>(x * 7 + y);
+		}
+	};
+	ASSERT_TRUE(render_image(path, width, height, 3, render, 3, 2));
+	const auto file = read_file(path);
+	EXPECT_EQ(read_u32(file, 16), width);
+	EXPECT_EQ(read_u32(file, 20), height);
+	EXPECT_EQ(file[25], 2);
+
+	const auto raw = read_png(file);
+	constexpr std::size_t row_size = width * 3 + 1;
+	ASSERT_EQ(raw.size(), row_size * height);
+	for (int y = 0; y < height; ++y) {
+		EXPECT_EQ(raw[y * row_size], 0);
+		for (std::size_t x = 0; x < width * 3; x += 997) {
+			EXPECT_EQ(raw[y * row_size + 1 + x], static_cast<unsigned char>(x * 7 + y));
+		}
+	}
+	std::filesystem::remove(path);
+}
+
+TEST(ppm, png_runs_compressed) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-runs.png").string();
+	// runs of every length around the length codes, then noise a band is stored for
+	constexpr int width = 4000;
+	constexpr int height = 300;
+	const auto render = [](int y, std::span<unsigned char> row) {
+		for (std::size_t x = 0; x < row.size(); ++x) {
+			row[x] = y < 200 ? static_cast<unsigned char>(x / (1 + y)) : static_cast<unsigned char>((x * 2654435761u + y * 40503u) >> 13);
+		}
+	};
+	ASSERT_TRUE(render_image(path, width, height, 1, render, 4, 16));
+	std::size_t idat_size = 0;
+	const auto raw = read_png(read_file(path), &idat_size);
+	constexpr std::size_t row_size = width + 1;
+	ASSERT_EQ(raw.size(), row_size * height);
+	for (int y = 0; y < height; ++y) {
+		std::vector<unsigned char> row(width);
+		render(y, row);
+		EXPECT_EQ(raw[y * row_size], 0);
+		EXPECT_TRUE(std::equal(row.begin(), row.end(), raw.begin() + y * row_size + 1)) << "row " << y;
+	}
+	// the noise is stored with little overhead, the runs are compressed
+	EXPECT_LT(idat_size, 100 * row_size + 50 * row_size);
+	std::filesystem::remove(path);
+}
+
+TEST(ppm, render_exception_propagates) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-failed.png").string();
+	const auto render = [](int y, std::span<unsigned char> row) {
+		if (y == 100) {
+			throw std::runtime_error("render failed");
+		}
+		std::fill(row.begin(), row.end(), static_cast<unsigned char>(y));
+	};
+	EXPECT_THROW(render_image(path, 16, 1000, 1, render, 4, 8), std::runtime_error);
+	EXPECT_THROW(render_image(path, 16, 1000, 1, render, 1, 8), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(ppm, stream_bytes) {
+	const auto path = (std::filesystem::temp_directory_path() / "tfr-unittest-stream.pgm").string();
+	ASSERT_TRUE(write_image<uint16_t>(path, create_counter_stream<uint16_t>(0x101), 4, 2));
+	const auto file = read_file(path);
+	const std::vector<unsigned char> pixels(file.end() - 8, file.end());
+	EXPECT_EQ(pixels, (std::vector<unsigned char>{1, 1, 2, 2, 3, 3, 4, 4}));
+	std::filesystem::remove(path);
+}
+}
@@ -1,5 +1,7 @@
 #include <util/statistic_analysis.h>
 
+#include <cmath>
+
 #include <gtest/gtest.h>
 
 #include "types.h"
@@ -46,5 +48,53 @@ TEST(statistic_analysis, p_value_0002321) {
 	EXPECT_EQ(m.to_string(), "minor(2)");
 }
 
+namespace {
+test_battery_result create_battery_result(const std::vector<double>& p_values) {
+	test_battery_result br;
+	for (std::size_t i = 0; i < p_values.size(); ++i) {
+		br.add({"s" + std::to_string(i), "m", 100, {test_type::uniform, i % 2 == 0 ? "a" : "b"}, statistic(statistic_type::chi2, 1, p_values[i], 10)});
+	}
+	return br;
+}
+}
+
+TEST(statistic_analysis, summary_worst) {
+	const auto br = create_battery_result({.5, .4, .999, .3, .2, .99});
+	EXPECT_EQ(br.worst({test_type::uniform, "a"}).stream_name, "s2");
+	EXPECT_EQ(br.worst({test_type::uniform, "b"}).stream_name, "s5");
+}
+
+TEST(statistic_analysis, summary_uniformity_updated_on_add) {
+	auto br = create_battery_result({.5, .4, .3, .2});
+	const test_key key{test_type::uniform, "a"};
+	const auto before = get_uniformity_statistic(br, key).value;
+	br.add({"s", "m", 100, key, statistic(statistic_type::chi2, 1, .999, 10)});
+	EXPECT_NE(get_uniformity_statistic(br, key).value, before);
+	EXPECT_EQ(get_uniformity_statistic(br, key).value, create_uniform_p_values_analysis(br[key]).stat.value);
+}
+
+TEST(statistic_analysis, summary_uniformity_binned_past_exact_limit) {
+	test_battery_result br;
+	const test_key key{test_type::uniform, "a"};
+	for (std::size_t i = 0; i < p_value_histogram::default_exact_limit + 100; ++i) {
+		const double p = std::fmod(static_cast<double>(i) * 0.6180339887, 1.);
+		br.add({"s", "m", 100, key, statistic(statistic_type::chi2, 1, p, 10)});
+		if (i + 1 == p_value_histogram::default_exact_limit) {
+			EXPECT_TRUE(br.summaries.at(key).binned_p_values.empty());
+			EXPECT_EQ(get_uniformity_statistic(br, key).value, create_uniform_p_values_analysis(br[key]).stat.value);
+		}
+	}
+	EXPECT_EQ(br.summaries.at(key).binned_p_values.size(), br[key].size());
+	EXPECT_EQ(get_uniformity_statistic(br, key).value, create_uniform_p_values_analysis(br[key]).stat.value);
+}
+
+TEST(statistic_analysis, worst_statistic_analysis_matches_analysis) {
+	const auto br = create_battery_result({.5, .4, .999, .3, .2, .99, .6, .7});
+	const auto ras = get_analysis(br);
+	ASSERT_EQ(ras.size(), 4);
+	EXPECT_EQ(ras.front().results, &br.results.at(ras.front().test_id));
+	EXPECT_EQ(get_worst_statistic_analysis(br)->stat.p_value, ras.front().analysis.stat.p_value);
+	EXPECT_FALSE(get_worst_statistic_analysis(test_battery_result{}));
+}
 
 }